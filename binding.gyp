@@ -9,6 +9,10 @@
       "sources": [
         "src/addon.cc",
       ],
+      "defines": [
+        # Env::SetInstanceData, which keeps the addon state per worker_thread
+        "NAPI_VERSION=6",
+      ],
       'include_dirs': [
         "./librealsense/include",
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -56,7 +60,8 @@
           'OS=="linux"',
           {
             "libraries": [
-              "-lrealsense2"
+              "-lrealsense2",
+              "-lrt"
             ],
             'ldflags': [
               # rpath for build from source
@@ -0,0 +1,29 @@
+const { addon } = require('../dist');
+
+// Converts a synthetic 1280x720 Z16 frame to meters, natively and with the usual JS loop.
+const width = 1280;
+const height = 720;
+const scale = 0.001;
+const depth = new Uint16Array(width * height);
+for (let i = 0; i < depth.length; i++) depth[i] = (i * 7919) & 0xffff;
+
+const native = new Float32Array(depth.length);
+const js = new Float32Array(depth.length);
+
+const time = (label, iterations, fn) => {
+  fn();
+  const begin = process.hrtime.bigint();
+  for (let i = 0; i < iterations; i++) fn();
+  const ms = Number(process.hrtime.bigint() - begin) / 1e6 / iterations;
+  console.log(`${label.padEnd(16)} ${ms.toFixed(3)} ms per frame`);
+  return ms;
+};
+
+const jsMs = time('JS loop', 100, () => {
+  for (let i = 0; i < depth.length; i++) js[i] = depth[i] * scale;
+});
+const nativeMs = time('depthToMeters', 100, () => addon.depthToMeters(depth, native, scale));
+
+let maxError = 0;
+for (let i = 0; i < depth.length; i++) maxError = Math.max(maxError, Math.abs(native[i] - js[i]));
+console.log(`speedup: ${(jsMs / nativeMs).toFixed(1)}x, max difference: ${maxError}`);
@@ -0,0 +1,52 @@
+const { addon, RSStreamType } = require('../dist');
+
+// Usage: node examples/depth-sampling-bench.js recording.bag [samples]
+const file = process.argv[2];
+const samples = Number(process.argv[3] || 4096);
+if (!file) {
+  console.error('Usage: node examples/depth-sampling-bench.js <recording.bag> [samples]');
+  process.exit(1);
+}
+
+const config = new addon.RSConfig();
+config.enableDeviceFromFile(file);
+config.enableStream(RSStreamType.Depth);
+
+const pipeline = new addon.RSPipeline().create();
+pipeline.start(config);
+
+const frames = pipeline.waitForFrames();
+const depth = frames.getFrame(RSStreamType.Depth, 0);
+const width = depth.getWidth();
+const height = depth.getHeight();
+
+const coords = new Int32Array(2 * samples);
+for (let i = 0; i < samples; i++) {
+  coords[2 * i] = Math.floor(Math.random() * width);
+  coords[2 * i + 1] = Math.floor(Math.random() * height);
+}
+const perPixel = new Float32Array(samples);
+const batched = new Float32Array(samples);
+const grid = new Float32Array(width * height);
+
+const time = (label, iterations, fn) => {
+  fn();
+  const begin = process.hrtime.bigint();
+  for (let i = 0; i < iterations; i++) fn();
+  const us = Number(process.hrtime.bigint() - begin) / 1e3 / iterations;
+  console.log(`${label.padEnd(28)} ${us.toFixed(1)} us`);
+};
+
+time(`getDistance x ${samples}`, 20, () => {
+  for (let i = 0; i < samples; i++) perPixel[i] = depth.getDistance(coords[2 * i], coords[2 * i + 1]);
+});
+time(`getDistances(${samples})`, 200, () => depth.getDistances(coords, batched));
+time(`getDistanceGrid(1, 1)`, 200, () => depth.getDistanceGrid(1, 1, grid));
+time(`getDistanceGrid(8, 8)`, 200, () => depth.getDistanceGrid(8, 8, grid));
+
+let maxError = 0;
+for (let i = 0; i < samples; i++) maxError = Math.max(maxError, Math.abs(perPixel[i] - batched[i]));
+console.log(`max difference against getDistance: ${maxError} m`);
+
+pipeline.stop();
+pipeline.destroy();
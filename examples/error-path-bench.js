@@ -0,0 +1,32 @@
+const { addon } = require('../dist');
+
+// Per-call cost of the native error path, for a call that succeeds and for one that fails.
+const iterations = 1e6;
+
+const time = (label, fn) => {
+  for (let i = 0; i < 1000; i++) fn();
+  const begin = process.hrtime.bigint();
+  for (let i = 0; i < iterations; i++) fn();
+  const ns = Number(process.hrtime.bigint() - begin) / iterations;
+  console.log(`${label.padEnd(24)} ${ns.toFixed(1)} ns per call`);
+};
+
+// An empty profile makes every intrinsics query fail inside librealsense.
+const profile = new addon.RSStreamProfile();
+
+time('success', () => addon.getTime());
+
+addon.setErrorMode('record');
+time('failure, record', () => profile.getVideoStreamIntrinsics());
+console.log('last error:', addon.getError());
+
+addon.setErrorMode('throw');
+time('failure, throw', () => {
+  try {
+    profile.getVideoStreamIntrinsics();
+  } catch (e) {}
+});
+
+addon.setErrorMode('callback');
+profile.destroy();
+addon.cleanup();
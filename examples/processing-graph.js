@@ -0,0 +1,37 @@
+const { addon, Pipeline, ProcessingGraph, RSOption, RSStreamType } = require('../dist');
+
+// Usage: node examples/processing-graph.js recording.bag
+const file = process.argv[2];
+if (!file) {
+  console.error('Usage: node examples/processing-graph.js <recording.bag>');
+  process.exit(1);
+}
+
+const config = new addon.RSConfig();
+config.enableDeviceFromFile(file);
+
+const graph = new ProcessingGraph([
+  'decimation',
+  { type: 'spatial', options: { [RSOption.FilterMagnitude]: 2 } },
+  'temporal',
+  'hole-filling',
+  { type: 'align', stream: RSStreamType.Color },
+  'colorizer',
+]);
+
+const pipeline = new Pipeline();
+let received = 0;
+
+pipeline.startWithProcessingGraph(graph, () => received++, config);
+
+setTimeout(() => {
+  const stats = graph.stats;
+  pipeline.stop();
+
+  console.log(`received ${received} results, ${stats.processed} framesets processed`);
+  console.log(`input dropped: ${stats.input.dropped}, errors: ${stats.errors}`);
+  console.log(`last chain run: ${stats.lastProcessingMs.toFixed(3)} ms on the worker thread`);
+
+  graph.destroy();
+  pipeline.destroy();
+}, 5000);
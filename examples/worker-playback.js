@@ -0,0 +1,54 @@
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+
+// Usage: node examples/worker-playback.js first.bag second.bag [...]
+// Streams every recording at the same time, each from its own worker_thread with its own addon instance.
+const seconds = 5;
+
+if (isMainThread) {
+  const files = process.argv.slice(2);
+  if (files.length < 2) {
+    console.error('Usage: node examples/worker-playback.js <first.bag> <second.bag> [...]');
+    process.exit(1);
+  }
+
+  const runs = files.map(file => new Promise((resolve, reject) => {
+    const worker = new Worker(__filename, { workerData: { file } });
+    worker.once('message', resolve);
+    worker.once('error', reject);
+  }));
+
+  Promise.all(runs).then(results => {
+    results.forEach(({ file, received, errors }) => {
+      console.log(`${file}: ${received} framesets, ${errors} native errors`);
+    });
+    const failed = results.some(({ received, errors }) => !received || errors);
+    process.exitCode = failed ? 1 : 0;
+  }, e => {
+    console.error(e);
+    process.exitCode = 1;
+  });
+}
+else {
+  const { addon, Pipeline } = require('../dist');
+
+  let errors = 0;
+  addon.registerErrorCallback({ callback: () => errors++ }, 'callback');
+
+  const config = new addon.RSConfig();
+  config.enableDeviceFromFile(workerData.file);
+
+  const pipeline = new Pipeline();
+  let received = 0;
+  pipeline.startWithCallback(frameSet => {
+    received++;
+    frameSet.destroy();
+  }, config);
+
+  setTimeout(() => {
+    pipeline.stop();
+    pipeline.destroy();
+    config.destroy();
+    addon.cleanup();
+    parentPort.postMessage({ file: workerData.file, received, errors });
+  }, seconds * 1000);
+}
@@ -1,3 +1,4 @@
+#include "addon_data.cc"
 #include "config.cc"
 #include "context.cc"
 #include "align.cc"
@@ -5,14 +6,23 @@
 #include "device_hub.cc"
 #include "device_list.cc"
 #include "devices_changed_callback.cc"
+#include "filter.cc"
 #include "frame.cc"
+#include "frame_bus.cc"
 #include "frameset.cc"
+#include "frame_publisher.cc"
+#include "framequeue.cc"
+#include "imu_batcher.cc"
 #include "colorizer.cc"
 #include "pipeline.cc"
 #include "pipeline_profile.cc"
+#include "pointcloud.cc"
+#include "pose_history.cc"
+#include "processing_graph.cc"
 #include "sensor.cc"
 #include "stream_profile.cc"
 #include "syncer.cc"
+#include <cmath>
 #include <librealsense2/h/rs_internal.h>
 #include <librealsense2/h/rs_pipeline.h>
 #include <librealsense2/hpp/rs_types.hpp>
@@ -26,9 +36,31 @@ Value GetError(const CallbackInfo& info) {
 	return ErrorUtil::GetJSErrorObject(info.Env());
 }
 
+/**
+ * info[0] -> Uint16Array of raw depth
+ * info[1] -> Float32Array receiving the depth in meters
+ * info[2] -> Meters per depth unit
+ */
+Value DepthToMeters(const CallbackInfo& info) {
+	if (!ExpectTypedArray(info[0], napi_uint16_array, "Uint16Array of raw depth")
+		|| !ExpectTypedArray(info[1], napi_float32_array, "Float32Array for the meters"))
+		return info.Env().Undefined();
+	if (!info[2].IsNumber() || !std::isfinite(info[2].As<Number>().DoubleValue())) {
+		TypeError::New(info.Env(), "Expected a finite depth scale").ThrowAsJavaScriptException();
+		return info.Env().Undefined();
+	}
+
+	auto src   = info[0].As<Uint16Array>();
+	auto out   = info[1].As<Float32Array>();
+	auto count = std::min(src.ElementLength(), out.ElementLength());
+	DepthKernels::DepthToMeters(src.Data(), count, info[2].As<Number>().FloatValue(), out.Data());
+
+	return Number::New(info.Env(), static_cast<double>(count));
+}
+
 Value GetTime(const CallbackInfo& info) {
 	rs2_error* e = nullptr;
-	auto time	= rs2_get_time(&e);
+	auto time	= GetNativeResult<rs2_time_t>(rs2_get_time, &e, &e);
 	return Number::New(info.Env(), time);
 }
 
@@ -39,22 +71,43 @@ Value RegisterErrorCallback(const CallbackInfo& info) {
 	return info.Env().Undefined();
 }
 
+/**
+ * info[0] -> How failures reach JS: "callback" (default), "throw" or "record"
+ */
+Value SetErrorMode(const CallbackInfo& info) {
+	auto mode = info[0].ToString().Utf8Value();
+	ErrorUtil::Init(info.Env());
+	if (!mode.compare("throw"))
+		ErrorUtil::SetMode(ErrorUtil::kModeThrow);
+	else if (!mode.compare("record"))
+		ErrorUtil::SetMode(ErrorUtil::kModeRecord);
+	else
+		ErrorUtil::SetMode(ErrorUtil::kModeCallback);
+
+	return info.Env().Undefined();
+}
+
 Value Cleanup(const CallbackInfo& info) {
 	// MainThreadCallback::Destroy();
-	ErrorUtil::ResetError();
+	ErrorUtil::Cleanup();
 
 	return info.Env().Undefined();
 }
 
 Object Init(Env env, Object exports) {
+	// Runs once per env, for the main thread and for every worker_thread that loads the addon.
+	AddonData::Init(env);
+	ErrorUtil::Init(env);
+
 	exports.Set("cleanup", Function::New(env, Cleanup));
+	exports.Set("depthToMeters", Function::New(env, DepthToMeters));
+	// Depends on the librealsense build, so getAllMetadata callers size their arrays from it.
+	exports.Set("frameMetadataCount", Number::New(env, RS2_FRAME_METADATA_COUNT));
 	exports.Set("getError", Function::New(env, GetError));
 	exports.Set("getTime", Function::New(env, GetTime));
 	exports.Set("registerErrorCallback", Function::New(env, RegisterErrorCallback));
+	exports.Set("setErrorMode", Function::New(env, SetErrorMode));
 
-	// RSFilter::Init(env, exports);
-	// RSFrameQueue::Init(env, exports);
-	// RSPointCloud::Init(env, exports);
 	RSAlign::Init(env, exports);
 	RSColorizer::Init(env, exports);
 	RSConfig::Init(env, exports);
@@ -62,10 +115,19 @@ Object Init(Env env, Object exports) {
 	RSDevice::Init(env, exports);
 	RSDeviceHub::Init(env, exports);
 	RSDeviceList::Init(env, exports);
+	RSFilter::Init(env, exports);
 	RSFrame::Init(env, exports);
+	RSFrameBus::Init(env, exports);
+	RSFrameBusSubscriber::Init(env, exports);
+	RSFramePublisher::Init(env, exports);
+	RSFrameQueue::Init(env, exports);
 	RSFrameSet::Init(env, exports);
+	RSImuBatcher::Init(env, exports);
 	RSPipeline::Init(env, exports);
 	RSPipelineProfile::Init(env, exports);
+	RSPointCloud::Init(env, exports);
+	RSPoseHistory::Init(env, exports);
+	RSProcessingGraph::Init(env, exports);
 	RSSensor::Init(env, exports);
 	RSStreamProfile::Init(env, exports);
 	RSSyncer::Init(env, exports);
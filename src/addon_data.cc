@@ -0,0 +1,84 @@
+#ifndef ADDON_DATA_H
+#define ADDON_DATA_H
+
+#include <functional>
+#include <memory>
+#include <napi.h>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+using namespace Napi;
+
+/**
+ * Everything the addon keeps per environment, attached to the env as its instance data.
+ *
+ * The main thread and every worker_thread that loads the addon get their own instance, so class
+ * constructors, JS references and registries of JS objects never leak from one environment into another.
+ * Modules keep their state here instead of in statics, keyed by the type of that state.
+ */
+class AddonData {
+  public:
+	// Must be called first thing when the addon is loaded into an env.
+	static AddonData* Init(Napi::Env env) {
+		auto data = env.GetInstanceData<AddonData>();
+		if (data) return data;
+
+		data = new AddonData();
+		env.SetInstanceData<AddonData, Finalize>(data);
+		return data;
+	}
+
+	static AddonData* Get(Napi::Env env) {
+		return env.GetInstanceData<AddonData>();
+	}
+
+	template<typename T>
+	static void SetConstructor(Napi::Env env, Function func) {
+		auto& constructor = Get(env)->constructors_[std::type_index(typeid(T))];
+		constructor		  = Napi::Persistent(func);
+	}
+
+	template<typename T>
+	static FunctionReference& Constructor(Napi::Env env) {
+		return Get(env)->constructors_[std::type_index(typeid(T))];
+	}
+
+	// The env's instance of T, created with args on first use and destroyed with the env.
+	template<typename T, typename... arguments>
+	static std::shared_ptr<T> Shared(Napi::Env env, arguments... args) {
+		auto& state = Get(env)->states_[std::type_index(typeid(T))];
+		if (!state) state = std::make_shared<T>(args...);
+
+		return std::static_pointer_cast<T>(state);
+	}
+
+	template<typename T>
+	static T& State(Napi::Env env) {
+		return *Shared<T>(env);
+	}
+
+	// Runs on the JS thread when the env is torn down, before any state is destroyed.
+	static void AtTeardown(Napi::Env env, std::function<void()> hook) {
+		Get(env)->teardown_hooks_.push_back(hook);
+	}
+
+  private:
+	AddonData() {
+	}
+
+	~AddonData() {
+		for (auto it = teardown_hooks_.rbegin(); it != teardown_hooks_.rend(); ++it)
+			(*it)();
+	}
+
+	static void Finalize(Napi::Env, AddonData* data) {
+		delete data;
+	}
+
+	std::unordered_map<std::type_index, FunctionReference> constructors_;
+	std::unordered_map<std::type_index, std::shared_ptr<void>> states_;
+	std::vector<std::function<void()>> teardown_hooks_;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef ALIGN_H
 #define ALIGN_H
 
+#include "addon_data.cc"
 #include "frame_callbacks.cc"
 #include "frameset.cc"
 #include <librealsense2/hpp/rs_types.hpp>
@@ -20,8 +21,7 @@ class RSAlign : public ObjectWrap<RSAlign> {
 			InstanceMethod("waitForFrames", &RSAlign::WaitForFrames),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSAlign>(env, func);
 		exports.Set("RSAlign", func);
 
 		return exports;
@@ -49,14 +49,11 @@ class RSAlign : public ObjectWrap<RSAlign> {
   private:
 	friend class RSPipeline;
 
-	static FunctionReference constructor;
-
 	rs2_processing_block* align_;
 	rs2_frame_queue* frame_queue_;
 	rs2_error* error_;
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (align_) rs2_delete_processing_block(align_);
 		align_ = nullptr;
@@ -99,6 +96,4 @@ class RSAlign : public ObjectWrap<RSAlign> {
 	}
 };
 
-Napi::FunctionReference RSAlign::constructor;
-
 #endif
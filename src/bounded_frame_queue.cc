@@ -0,0 +1,205 @@
+#ifndef BOUNDED_FRAME_QUEUE_H
+#define BOUNDED_FRAME_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A fixed-capacity frame queue that sits between a librealsense callback thread and a consumer.
+ * The queue owns every frame it holds, and the overflow policy decides what a full queue does:
+ *   - kLatestOnly: keeps a single slot, a new frame replaces the undelivered one
+ *   - kDropOldest: releases the oldest queued frame to make room
+ *   - kBlock: stalls the producer until the consumer makes room, or the queue is closed
+ * Slots are preallocated, so pushing and popping never allocate. With `keep_frames`, every queued frame is
+ * detached from the librealsense frame pool, so a deep queue does not starve the device of buffers.
+ */
+class BoundedFrameQueue {
+  public:
+	enum Policy {
+		kLatestOnly = 0,
+		kDropOldest,
+		kBlock,
+	};
+
+	struct Stats {
+		uint32_t depth;
+		uint32_t capacity;
+		uint32_t high_water;
+		double enqueued;
+		double dropped;
+		double delivered;
+	};
+
+	static bool ParsePolicy(const std::string& name, Policy* policy) {
+		if (!name.compare("latest-only"))
+			*policy = kLatestOnly;
+		else if (!name.compare("drop-oldest"))
+			*policy = kDropOldest;
+		else if (!name.compare("block"))
+			*policy = kBlock;
+		else
+			return false;
+
+		return true;
+	}
+
+	BoundedFrameQueue(Policy policy, uint32_t capacity, bool keep_frames = false)
+	  : policy_(policy)
+	  , keep_frames_(keep_frames)
+	  , slots_(policy == kLatestOnly || !capacity ? 1 : capacity, nullptr)
+	  , head_(0)
+	  , size_(0)
+	  , high_water_(0)
+	  , closed_(false)
+	  , enqueued_(0)
+	  , dropped_(0)
+	  , delivered_(0) {
+	}
+
+	~BoundedFrameQueue() {
+		Clear();
+	}
+
+	/**
+	 * Hands a frame over to the queue. Returns false when the frame was released instead of queued,
+	 * which only happens once the queue has been closed.
+	 */
+	bool Push(rs2_frame* frame) {
+		if (keep_frames_) rs2_keep_frame(frame);
+
+		rs2_frame* evicted = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (policy_ == kBlock) not_full_.wait(lock, [this] { return closed_ || size_ < slots_.size(); });
+			if (closed_) {
+				dropped_++;
+				lock.unlock();
+				rs2_release_frame(frame);
+				return false;
+			}
+			if (size_ == slots_.size()) {
+				evicted		= slots_[head_];
+				head_		= (head_ + 1) % slots_.size();
+				size_--;
+				dropped_++;
+			}
+
+			slots_[(head_ + size_) % slots_.size()] = frame;
+			size_++;
+			enqueued_++;
+			if (size_ > high_water_) high_water_ = size_;
+		}
+		not_empty_.notify_one();
+		if (evicted) rs2_release_frame(evicted);
+
+		return true;
+	}
+
+	bool TryPop(rs2_frame** frame) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!size_) return false;
+
+			*frame = PopLocked();
+		}
+		not_full_.notify_one();
+
+		return true;
+	}
+
+	/**
+	 * Blocks the calling (non-JS) thread until a frame arrives, the timeout expires or the queue is closed.
+	 */
+	bool Pop(rs2_frame** frame, uint32_t timeout_ms) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			auto ready = not_empty_.wait_for(
+			  lock, std::chrono::milliseconds(timeout_ms), [this] { return closed_ || size_ > 0; });
+			if (!ready || !size_) return false;
+
+			*frame = PopLocked();
+		}
+		not_full_.notify_one();
+
+		return true;
+	}
+
+	/**
+	 * Rejects further frames and wakes every blocked producer and consumer.
+	 * Must be called before stopping a producer that may be blocked in Push.
+	 */
+	void Close() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+		}
+		not_full_.notify_all();
+		not_empty_.notify_all();
+	}
+
+	void Open() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		closed_ = false;
+	}
+
+	bool IsClosed() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return closed_;
+	}
+
+	void Clear() {
+		std::vector<rs2_frame*> released;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			while (size_) {
+				released.push_back(slots_[head_]);
+				head_ = (head_ + 1) % slots_.size();
+				size_--;
+			}
+		}
+		not_full_.notify_all();
+		for (auto frame : released) rs2_release_frame(frame);
+	}
+
+	Stats GetStats() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		Stats stats;
+		stats.depth		 = size_;
+		stats.capacity	 = slots_.size();
+		stats.high_water = high_water_;
+		stats.enqueued	 = static_cast<double>(enqueued_);
+		stats.dropped	 = static_cast<double>(dropped_);
+		stats.delivered	 = static_cast<double>(delivered_);
+		return stats;
+	}
+
+  private:
+	rs2_frame* PopLocked() {
+		rs2_frame* frame = slots_[head_];
+		slots_[head_]	 = nullptr;
+		head_			 = (head_ + 1) % slots_.size();
+		size_--;
+		delivered_++;
+		return frame;
+	}
+
+	Policy policy_;
+	bool keep_frames_;
+	std::vector<rs2_frame*> slots_;
+	size_t head_;
+	size_t size_;
+	size_t high_water_;
+	bool closed_;
+	uint64_t enqueued_;
+	uint64_t dropped_;
+	uint64_t delivered_;
+	std::mutex mutex_;
+	std::condition_variable not_full_;
+	std::condition_variable not_empty_;
+};
+
+#endif
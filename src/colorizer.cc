@@ -1,6 +1,7 @@
 #ifndef COLORIZER_H
 #define COLORIZER_H
 
+#include "addon_data.cc"
 #include "frame.cc"
 #include "frame_callbacks.cc"
 #include "options.cc"
@@ -29,11 +30,12 @@ class RSColorizer
 			InstanceMethod("isOptionReadonly", &RSColorizer::IsOptionReadonly),
 			InstanceMethod("getOptionDescription", &RSColorizer::GetOptionDescription),
 			InstanceMethod("getOptionValueDescription", &RSColorizer::GetOptionValueDescription),
+			InstanceMethod("getAllOptions", &RSColorizer::GetAllOptions),
+			InstanceMethod("applyOptions", &RSColorizer::ApplyOptions),
 
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSColorizer>(env, func);
 		exports.Set("RSColorizer", func);
 
 		return exports;
@@ -41,7 +43,7 @@ class RSColorizer
 
 	static Object NewInstance(Napi::Env env) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSColorizer>(env).New({});
 
 		return scope.Escape(napi_value(instance)).ToObject();
 	}
@@ -64,7 +66,6 @@ class RSColorizer
 
   private:
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (colorizer_) rs2_delete_processing_block(colorizer_);
 		colorizer_ = nullptr;
@@ -115,6 +116,14 @@ class RSColorizer
 		return this->SupportsOptionInternal(info);
 	}
 
+	Napi::Value GetAllOptions(const CallbackInfo& info) {
+		return this->GetAllOptionsInternal(info);
+	}
+
+	Napi::Value ApplyOptions(const CallbackInfo& info) {
+		return this->ApplyOptionsInternal(info);
+	}
+
 	Napi::Value GetOption(const CallbackInfo& info) {
 		return this->GetOptionInternal(info);
 	}
@@ -140,13 +149,9 @@ class RSColorizer
 	}
 
   private:
-	static FunctionReference constructor;
-
 	rs2_processing_block* colorizer_;
 	rs2_frame_queue* frame_queue_;
 	rs2_error* error_;
 };
 
-Napi::FunctionReference RSColorizer::constructor;
-
 #endif
@@ -1,6 +1,7 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "addon_data.cc"
 #include "utils.cc"
 #include <librealsense2/hpp/rs_types.hpp>
 #include <napi.h>
@@ -25,8 +26,7 @@ class RSConfig : public ObjectWrap<RSConfig> {
 			InstanceMethod("enableStream", &RSConfig::EnableStream),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSConfig>(env, func);
 		exports.Set("RSConfig", func);
 
 		return exports;
@@ -34,7 +34,7 @@ class RSConfig : public ObjectWrap<RSConfig> {
 
 	static Object NewInstance(Napi::Env env) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSConfig>(env).New({});
 
 		return scope.Escape(napi_value(instance)).ToObject();
 	}
@@ -43,7 +43,7 @@ class RSConfig : public ObjectWrap<RSConfig> {
 	  : ObjectWrap<RSConfig>(info)
 	  , config_(nullptr)
 	  , error_(nullptr) {
-		this->config_ = rs2_create_config(&this->error_);
+		this->config_ = GetNativeResult<rs2_config*>(rs2_create_config, &this->error_, &this->error_);
 	}
 
 	~RSConfig() {
@@ -51,14 +51,13 @@ class RSConfig : public ObjectWrap<RSConfig> {
 	}
 
   private:
-	static FunctionReference constructor;
 	friend class RSPipeline;
+	friend class RSProcessingGraph;
 
 	rs2_config* config_;
 	rs2_error* error_;
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (config_) rs2_delete_config(config_);
 		config_ = nullptr;
@@ -142,6 +141,4 @@ class RSConfig : public ObjectWrap<RSConfig> {
 	}
 };
 
-Napi::FunctionReference RSConfig::constructor;
-
 #endif
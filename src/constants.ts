@@ -102,6 +102,102 @@ export enum RSFormat {
   W10,
 }
 
+/** Index of each field written by RSFrame.readHeader; Count is the length the output needs */
+export enum RSFrameHeader {
+  /** Video frames only, 0 otherwise */
+  Width,
+  /** Video frames only, 0 otherwise */
+  Height,
+  /** Video frames only, 0 otherwise */
+  StrideInBytes,
+  /** Video frames only, 0 otherwise */
+  BitsPerPixel,
+  Timestamp,
+  TimestampDomain,
+  FrameNumber,
+  DataSize,
+  StreamType,
+  Format,
+  StreamIndex,
+  UniqueId,
+  Fps,
+  Count,
+}
+
+/** Offset of each field written by RSFrame.getPoseData(Float32Array); Count is the length the output needs */
+export enum RSPoseField {
+  /** x, y, z in meters */
+  Translation = 0,
+  /** x, y, z in meters per second */
+  Velocity = 3,
+  /** x, y, z in meters per second squared */
+  Acceleration = 6,
+  /** Quaternion x, y, z, w */
+  Rotation = 9,
+  /** x, y, z in radians per second */
+  AngularVelocity = 13,
+  /** x, y, z in radians per second squared */
+  AngularAcceleration = 16,
+  TrackerConfidence = 19,
+  MapperConfidence = 20,
+  Count = 21,
+}
+
+/** Bits of RSFrame.type, one per frame extension; a frame may have several, e.g. Video | Depth */
+export enum RSFrameTypeFlag {
+  Video = 1 << 0,
+  Depth = 1 << 1,
+  Disparity = 1 << 2,
+  Motion = 1 << 3,
+  Pose = 1 << 4,
+  Points = 1 << 5,
+  Composite = 1 << 6,
+}
+
+/** Int32 words at the start of an RSFramePublisher or RSFrameBus ring */
+export enum RSFrameRingHeader {
+  Magic = 0,
+  SlotCount = 1,
+  SlotBytes = 2,
+  /** Index of the slot written last, -1 until the first frame */
+  Latest = 3,
+  Published = 4,
+  /** Frames larger than a slot, which were left out */
+  Skipped = 5,
+  /** Processes blocked in RSFrameBusSubscriber.waitForFrame */
+  Waiters = 6,
+  Words = 16,
+}
+
+/** Int32 words at the start of every ring slot, followed by the frame data */
+export enum RSFrameSlotHeader {
+  /** Odd while the slot is being written */
+  Sequence = 0,
+  Stream = 1,
+  StreamIndex = 2,
+  Format = 3,
+  Width = 4,
+  Height = 5,
+  Stride = 6,
+  BitsPerPixel = 7,
+  DataSize = 8,
+  FrameNumberLow = 9,
+  FrameNumberHigh = 10,
+  TimestampDomain = 11,
+  /** A Float64 spanning this word and the next */
+  Timestamp = 12,
+  Words = 16,
+}
+
+/** Per-option result of applyOptions() */
+export enum RSOptionApplyStatus {
+  Unchanged = 0,
+  Set = 1,
+  Unsupported = -1,
+  ReadOnly = -2,
+  Failed = -3,
+}
+
 export enum RSFrameMetadata {
   /** A sequential index managed per-stream. Integer value */
   FrameCounter,
@@ -1,6 +1,7 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#include "addon_data.cc"
 #include "device.cc"
 #include "device_list.cc"
 // #include "devices_changed_callback.cc"
@@ -37,8 +38,7 @@ class RSContext : public ObjectWrap<RSContext> {
 			InstanceMethod("unloadDeviceFile", &RSContext::UnloadDeviceFile),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSContext>(env, func);
 		exports.Set("RSContext", func);
 
 		return exports;
@@ -46,7 +46,7 @@ class RSContext : public ObjectWrap<RSContext> {
 
 	static Object NewInstance(Napi::Env env, rs2_context* ctx_ptr = nullptr) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSContext>(env).New({});
 
 		// If ctx_ptr is provided, no need to call create.
 		if (ctx_ptr) {
@@ -116,8 +116,6 @@ class RSContext : public ObjectWrap<RSContext> {
 	}
 
   private:
-	static FunctionReference constructor;
-
 	FunctionReference device_changed_callback_;
 	rs2_context* ctx_;
 	rs2_error* error_;
@@ -134,7 +132,6 @@ class RSContext : public ObjectWrap<RSContext> {
 	void RegisterDevicesChangedCallbackMethod(std::shared_ptr<ThreadSafeCallback> fn);
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (ctx_) rs2_delete_context(ctx_);
 		ctx_ = nullptr;
@@ -184,6 +181,4 @@ class RSContext : public ObjectWrap<RSContext> {
 	}
 };
 
-Napi::FunctionReference RSContext::constructor;
-
 #endif
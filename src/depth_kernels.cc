@@ -0,0 +1,109 @@
+#ifndef DEPTH_KERNELS_H
+#define DEPTH_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DEPTH_KERNELS_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEPTH_KERNELS_NEON
+#endif
+
+/**
+ * Converts raw Z16 depth units into meters: dst[i] = src[i] * scale.
+ *
+ * On x86, the AVX2 kernel is picked at runtime when the CPU supports it, otherwise SSE2 (which every x86-64
+ * CPU has) is used; ARM builds use NEON, and anything else the scalar loop. Every path gives the same result
+ * as the scalar loop, since each one is a single float multiply per pixel.
+ */
+namespace DepthKernels {
+
+inline void DepthToMetersScalar(const uint16_t* src, size_t count, float scale, float* dst) {
+	for (size_t i = 0; i < count; i++) dst[i] = src[i] * scale;
+}
+
+#ifdef DEPTH_KERNELS_X86
+__attribute__((target("sse2"))) inline void DepthToMetersSSE2(
+  const uint16_t* src, size_t count, float scale, float* dst) {
+	const __m128 factor = _mm_set1_ps(scale);
+	const __m128i zero	= _mm_setzero_si128();
+	size_t i			= 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128 lo	  = _mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, zero));
+		const __m128 hi	  = _mm_cvtepi32_ps(_mm_unpackhi_epi16(raw, zero));
+		_mm_storeu_ps(dst + i, _mm_mul_ps(lo, factor));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(hi, factor));
+	}
+	DepthToMetersScalar(src + i, count - i, scale, dst + i);
+}
+
+__attribute__((target("avx2"))) inline void DepthToMetersAVX2(
+  const uint16_t* src, size_t count, float scale, float* dst) {
+	const __m256 factor = _mm256_set1_ps(scale);
+	size_t i			= 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m128i raw_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i raw_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+		const __m256 lo		 = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(raw_lo));
+		const __m256 hi		 = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(raw_hi));
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(lo, factor));
+		_mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(hi, factor));
+	}
+	DepthToMetersSSE2(src + i, count - i, scale, dst + i);
+}
+
+inline bool HasAVX2() {
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+#endif
+
+#ifdef DEPTH_KERNELS_NEON
+inline void DepthToMetersNEON(const uint16_t* src, size_t count, float scale, float* dst) {
+	const float32x4_t factor = vdupq_n_f32(scale);
+	size_t i				 = 0;
+	for (; i + 8 <= count; i += 8) {
+		const uint16x8_t raw = vld1q_u16(src + i);
+		vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(raw))), factor));
+		vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(raw))), factor));
+	}
+	DepthToMetersScalar(src + i, count - i, scale, dst + i);
+}
+#endif
+
+inline void DepthToMeters(const uint16_t* src, size_t count, float scale, float* dst) {
+#if defined(DEPTH_KERNELS_X86)
+	if (HasAVX2())
+		DepthToMetersAVX2(src, count, scale, dst);
+	else
+		DepthToMetersSSE2(src, count, scale, dst);
+#elif defined(DEPTH_KERNELS_NEON)
+	DepthToMetersNEON(src, count, scale, dst);
+#else
+	DepthToMetersScalar(src, count, scale, dst);
+#endif
+}
+
+/**
+ * Converts a width x height region whose rows start src_stride and dst_stride elements apart.
+ */
+inline void DepthToMeters2D(
+  const uint16_t* src,
+  size_t src_stride,
+  size_t width,
+  size_t height,
+  float scale,
+  float* dst,
+  size_t dst_stride) {
+	if (src_stride == width && dst_stride == width) return DepthToMeters(src, width * height, scale, dst);
+
+	for (size_t y = 0; y < height; y++) DepthToMeters(src + y * src_stride, width, scale, dst + y * dst_stride);
+}
+
+}  // namespace DepthKernels
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef DEVICE_H
 #define DEVICE_H
 
+#include "addon_data.cc"
 #include "sensor.cc"
 #include "utils.cc"
 #include <librealsense2/hpp/rs_types.hpp>
@@ -57,8 +58,7 @@ class RSDevice : public Napi::ObjectWrap<RSDevice> {
 
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSDevice>(env, func);
 		exports.Set("RSDevice", func);
 
 		return exports;
@@ -66,7 +66,7 @@ class RSDevice : public Napi::ObjectWrap<RSDevice> {
 
 	static Object NewInstance(Napi::Env env, rs2_device* dev, DeviceType type = kNormalDevice) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSDevice>(env).New({});
 
 		auto unwrapped   = ObjectWrap<RSDevice>::Unwrap(instance);
 		unwrapped->dev_  = dev;
@@ -88,8 +88,6 @@ class RSDevice : public Napi::ObjectWrap<RSDevice> {
 	}
 
   private:
-  	static FunctionReference constructor;
-
 	rs2_device* dev_;
 	rs2_error* error_;
 	DeviceType type_;
@@ -102,7 +100,6 @@ class RSDevice : public Napi::ObjectWrap<RSDevice> {
 	friend class PlaybackStatusCallbackInfo;
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (dev_) rs2_delete_device(dev_);
 		dev_ = nullptr;
@@ -348,6 +345,4 @@ class RSDevice : public Napi::ObjectWrap<RSDevice> {
 	}
 };
 
-FunctionReference RSDevice::constructor;
-
 #endif
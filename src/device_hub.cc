@@ -1,6 +1,7 @@
 #ifndef DEVICE_HUB_H
 #define DEVICE_HUB_H
 
+#include "addon_data.cc"
 #include "context.cc"
 #include "device.cc"
 #include <librealsense2/hpp/rs_types.hpp>
@@ -20,8 +21,7 @@ class RSDeviceHub : public ObjectWrap<RSDeviceHub> {
 			InstanceMethod("destroy", &RSDeviceHub::Destroy),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSDeviceHub>(env, func);
 		exports.Set("RSDeviceHub", func);
 
 		return exports;
@@ -29,7 +29,7 @@ class RSDeviceHub : public ObjectWrap<RSDeviceHub> {
 
 	static Object NewInstance(Napi::Env env) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSDeviceHub>(env).New({});
 
 		return scope.Escape(napi_value(instance)).ToObject();
 	}
@@ -50,7 +50,6 @@ class RSDeviceHub : public ObjectWrap<RSDeviceHub> {
 
   private:
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 
 		if (hub_) rs2_delete_device_hub(hub_);
@@ -83,13 +82,9 @@ class RSDeviceHub : public ObjectWrap<RSDeviceHub> {
 	}
 
   private:
-	static FunctionReference constructor;
-
 	rs2_device_hub* hub_;
 	rs2_context* ctx_;
 	rs2_error* error_;
 };
 
-Napi::FunctionReference RSDeviceHub::constructor;
-
 #endif
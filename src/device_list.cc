@@ -1,6 +1,7 @@
 #ifndef DEVICE_LIST_H
 #define DEVICE_LIST_H
 
+#include "addon_data.cc"
 #include <napi.h>
 #include <librealsense2/hpp/rs_types.hpp>
 #include "device.cc"
@@ -21,8 +22,7 @@ class RSDeviceList : public ObjectWrap<RSDeviceList> {
 			InstanceMethod("getDevice", &RSDeviceList::GetDevice),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSDeviceList>(env, func);
 		exports.Set("RSDeviceList", func);
 
 		return exports;
@@ -30,7 +30,7 @@ class RSDeviceList : public ObjectWrap<RSDeviceList> {
 
 	static Object NewInstance(Napi::Env env, rs2_device_list* list) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSDeviceList>(env).New({});
 
 		auto unwrapped = ObjectWrap<RSDeviceList>::Unwrap(instance);
 		unwrapped->list_ = list;
@@ -50,7 +50,6 @@ class RSDeviceList : public ObjectWrap<RSDeviceList> {
 
   private:
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (list_) rs2_delete_device_list(list_);
 		list_ = nullptr;
@@ -103,11 +102,8 @@ class RSDeviceList : public ObjectWrap<RSDeviceList> {
 		return Number::New(info.Env(), length);
 	}
 
-	static FunctionReference constructor;
 	rs2_error* error_;
 	rs2_device_list* list_;
 };
 
-Napi::FunctionReference RSDeviceList::constructor;
-
 #endif
@@ -50,7 +50,12 @@ class DevicesChangedCallback : public rs2_devices_changed_callback {
 
 void RSContext::RegisterDevicesChangedCallbackMethod(std::shared_ptr<ThreadSafeCallback> callback) {
 	std::cerr << "RSContext::RegisterDevicesChangedCallbackMethod" << std::endl;
-	rs2_set_devices_changed_callback_cpp(this->ctx_, new DevicesChangedCallback(callback), &this->error_);
+	CallNativeFunc(
+	  rs2_set_devices_changed_callback_cpp,
+	  &this->error_,
+	  this->ctx_,
+	  new DevicesChangedCallback(callback),
+	  &this->error_);
 }
 
 #endif
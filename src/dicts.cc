@@ -1,6 +1,7 @@
 #ifndef DICTS_H
 #define DICTS_H
 
+#include "bounded_frame_queue.cc"
 #include "dict_base.cc"
 #include <librealsense2/hpp/rs_types.hpp>
 #include <napi.h>
@@ -16,6 +17,19 @@ class RSExtrinsics : public DictBase {
 	}
 };
 
+class RSFrameQueueStats : public DictBase {
+  public:
+	RSFrameQueueStats(Napi::Env env, const BoundedFrameQueue::Stats& stats)
+	  : DictBase(env) {
+		SetMemberT("depth", stats.depth);
+		SetMemberT("capacity", stats.capacity);
+		SetMemberT("highWater", stats.high_water);
+		SetMemberT("enqueued", stats.enqueued);
+		SetMemberT("dropped", stats.dropped);
+		SetMemberT("delivered", stats.delivered);
+	}
+};
+
 class RSIntrinsics : public DictBase {
   public:
 	explicit RSIntrinsics(Napi::Env env, rs2_intrinsics intrinsics)
@@ -1,65 +1,92 @@
 #ifndef ERRORUTIL_H
 #define ERRORUTIL_H
 
+#include "addon_data.cc"
 #include "dict_base.cc"
+#include "js_thread_signal.cc"
 #include <iostream>
 #include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <mutex>
 #include <napi.h>
 #include <string>
+#include <vector>
 
 using namespace Napi;
 
-class ErrorUtil {
+/**
+ * Tracks the error of the last failed librealsense call made on a JS thread, one instance per env.
+ *
+ * The error is adopted as is: nothing is copied on failure and the strings JS sees are only built when a
+ * callback or getError() needs them. It is freed by the next wrapped call, by a newer error or by cleanup(),
+ * so a successful call costs a single pointer test. Callers keep their rs2_error* only as a failure flag and
+ * never free what they handed over.
+ *
+ * Each JS thread, the main one or a worker_thread, finds its env's instance in thread-local storage, set by
+ * Init(). Any other thread has no instance of its own: its errors are queued on the instance bound with a
+ * ForwardScope, or else the first env's, and handed to that JS thread through a signal, where they are
+ * adopted and reported as if they had been rejected. So the wrapped calls in utils.cc work from any thread.
+ */
+class ErrorUtil : public std::enable_shared_from_this<ErrorUtil> {
   public:
-	class ErrorInfo {
-	  public:
-		ErrorInfo()
-		  : is_error_(false)
-		  , recoverable_(false) {
-		}
-
-		~ErrorInfo() {
-		}
-
-		void Update(bool is_error, bool recoverable, std::string description, std::string function) {
-			is_error_		 = is_error;
-			recoverable_	 = recoverable;
-			description_	 = description;
-			native_function_ = function;
-		}
+	// How a failure reaches JS, set by setErrorMode()
+	enum Mode {
+		// The registered error callback is called right away, the historical behavior
+		kModeCallback = 0,
+		// A JS Error is thrown from the native method that failed
+		kModeThrow,
+		// Nothing is called, JS reads getError() when it wants to
+		kModeRecord
+	};
 
-		void Reset() {
-			Update(false, false, "", "");
+	/**
+	 * Sends the errors of the current native thread to one env until the scope ends, e.g. in a callback
+	 * that librealsense runs on its own threads for objects created by that env.
+	 */
+	class ForwardScope {
+	  public:
+		explicit ForwardScope(const std::shared_ptr<ErrorUtil>& target)
+		  : previous_(forward_to_) {
+			forward_to_ = target.get();
 		}
-
-		// set value to js attributes only when this method is called
-		Object GetJSObject(Env env) {
-			auto obj = Object::New(env);
-			obj.Set("recoverable", recoverable_);
-			obj.Set("description", description_);
-			obj.Set("nativeFunction", native_function_);
-
-			return obj;
+		~ForwardScope() {
+			forward_to_ = previous_;
 		}
 
 	  private:
-		bool is_error_;
-		bool recoverable_;
-		std::string description_;
-		std::string native_function_;
-
-		friend class ErrorUtil;
+		ErrorUtil* previous_;
 	};
 
 	ErrorUtil(Env env)
-	  : env_(env) {
+	  : env_(env)
+	  , mode_(kModeCallback)
+	  , last_error_(nullptr)
+	  , closed_(false) {
 	}
 
 	~ErrorUtil() {
+		Clear();
+		DropForwarded();
 	}
 
+	// Must be called on the JS thread of env, whose errors are then reported synchronously.
 	static void Init(Env env) {
-		if (!singleton_) singleton_ = new ErrorUtil(env);
+		if (current_) return;
+
+		auto self = AddonData::Shared<ErrorUtil>(env, env);
+		current_  = self.get();
+		// The function is never called, forwarded errors are drained by the handler.
+		if (self->signal_.Start(env, Function::New(env, Noop), "RSErrorForwarder", DeliverForwarded, current_))
+			self->signal_.Unref(env);
+
+		std::shared_ptr<ErrorUtil> none;
+		std::atomic_compare_exchange_strong(&fallback_, &none, self);
+		AddonData::AtTeardown(env, [self] { self->Shutdown(); });
+	}
+
+	// The instance of the calling JS thread, for native callbacks to forward their errors to.
+	static std::shared_ptr<ErrorUtil> Current() {
+		return current_ ? current_->shared_from_this() : nullptr;
 	}
 
 	/**
@@ -67,56 +94,194 @@ class ErrorUtil {
 	 * info[1] -> The key of the function to call
 	 */
 	static void UpdateJSErrorCallback(const CallbackInfo& info) {
-		singleton_->js_error_container_.Reset(info[0].As<Object>());
-		auto value							= std::string(info[1].As<String>());
-		singleton_->js_error_callback_name_ = value;
+		if (!current_) return;
+
+		current_->js_error_container_.Reset(info[0].As<Object>(), 1);
+		auto value						  = std::string(info[1].As<String>());
+		current_->js_error_callback_name_ = value;
+	}
+
+	static void SetMode(Mode mode) {
+		if (current_) current_->mode_ = mode;
 	}
 
+	// Takes ownership of the error of a failed call and reports it according to the mode.
 	static void AnalyzeError(rs2_error* err) {
+		Adopt(err, true);
+	}
+
+	// Same as AnalyzeError for an error already handed to JS as a rejected promise, which is never thrown again.
+	static void AnalyzeRejectedError(rs2_error* err) {
+		Adopt(err, false);
+	}
+
+	// The per-call reset, a pointer test unless the previous call on this JS thread failed.
+	static void ResetError() {
+		if (current_ && current_->last_error_) current_->Clear();
+	}
+
+	// Must be called on a JS thread. Frees the held error and any forwarded one not yet delivered.
+	static void Cleanup() {
+		if (!current_) return;
+
+		current_->Clear();
+		current_->DropForwarded();
+	}
+
+	static Value GetJSErrorObject(Env env) {
+		if (!current_ || !current_->last_error_) return env.Undefined();
+
+		return current_->GetJSObject(env);
+	}
+
+  private:
+	static void Adopt(rs2_error* err, bool may_throw) {
 		if (!err) return;
+		if (current_) {
+			current_->Clear();
+			current_->last_error_ = err;
+			current_->MarkError(may_throw);
+			return;
+		}
+		if (forward_to_) {
+			forward_to_->Forward(err);
+			return;
+		}
 
-		auto function	= std::string(rs2_get_failed_function(err));
-		auto type		 = rs2_get_librealsense_exception_type(err);
-		auto msg		 = std::string(rs2_get_error_message(err));
-		bool recoverable = false;
+		auto fallback = std::atomic_load(&fallback_);
+		if (fallback)
+			fallback->Forward(err);
+		else
+			rs2_free_error(err);
+	}
 
+	// Runs on the JS thread when the env goes away; native threads may still hold the instance after that.
+	void Shutdown() {
+		{
+			std::lock_guard<std::mutex> lock(forward_mutex_);
+			closed_ = true;
+		}
+		signal_.Stop();
+		js_error_container_.Reset();
+		Clear();
+		DropForwarded();
+
+		auto self = shared_from_this();
+		std::atomic_compare_exchange_strong(&fallback_, &self, std::shared_ptr<ErrorUtil>());
+		if (current_ == this) current_ = nullptr;
+	}
+
+	static bool IsRecoverable(rs2_exception_type type) {
 		switch (type) {
 			case RS2_EXCEPTION_TYPE_INVALID_VALUE:
 			case RS2_EXCEPTION_TYPE_WRONG_API_CALL_SEQUENCE:
-			case RS2_EXCEPTION_TYPE_NOT_IMPLEMENTED:
-				recoverable = true;
-				break;
-			default: break;
+			case RS2_EXCEPTION_TYPE_NOT_IMPLEMENTED: return true;
+			default: return false;
 		}
+	}
 
-		singleton_->MarkError(recoverable, msg, function);
+	void Clear() {
+		if (last_error_) rs2_free_error(last_error_);
+		last_error_ = nullptr;
 	}
 
-	static void ResetError() {
-		singleton_->error_info_.Reset();
+	// Called on a native thread, the error then belongs to the queue.
+	void Forward(rs2_error* err) {
+		{
+			std::lock_guard<std::mutex> lock(forward_mutex_);
+			if (!closed_) {
+				forwarded_.push_back(err);
+				err = nullptr;
+			}
+		}
+		if (err)
+			rs2_free_error(err);
+		else
+			signal_.Signal();
 	}
 
-	static Value GetJSErrorObject(Env env) {
-		if (singleton_->error_info_.is_error_) return singleton_->error_info_.GetJSObject(env);
+	void DropForwarded() {
+		std::vector<rs2_error*> forwarded;
+		{
+			std::lock_guard<std::mutex> lock(forward_mutex_);
+			forwarded.swap(forwarded_);
+		}
+		for (auto err : forwarded)
+			rs2_free_error(err);
+	}
 
-		return env.Undefined();
+	static void Noop(const CallbackInfo&) {
 	}
 
-  private:
-	// Save detailed error info to the js object
-	void MarkError(bool recoverable, std::string description, std::string native_function) {
-		error_info_.Update(true, recoverable, description, native_function);
+	// Forwarded errors have no JS call to throw from, so every mode treats them like rejected ones.
+	static void DeliverForwarded(Napi::Env env, Function, void* context) {
+		auto self = static_cast<ErrorUtil*>(context);
+		std::vector<rs2_error*> forwarded;
+		{
+			std::lock_guard<std::mutex> lock(self->forward_mutex_);
+			forwarded.swap(self->forwarded_);
+		}
+
+		HandleScope scope(env);
+		for (size_t i = 0; i < forwarded.size(); i++) {
+			try {
+				Adopt(forwarded[i], false);
+			}
+			catch (const Error& e) {
+				// The rest would only hit the pending exception, so they are dropped.
+				for (size_t j = i + 1; j < forwarded.size(); j++)
+					rs2_free_error(forwarded[j]);
+				e.ThrowAsJavaScriptException();
+				return;
+			}
+		}
+	}
+
+	// Set value to js attributes only when this method is called
+	Object GetJSObject(Env env) {
+		auto obj = Object::New(env);
+		obj.Set("recoverable", IsRecoverable(rs2_get_librealsense_exception_type(last_error_)));
+		obj.Set("description", rs2_get_error_message(last_error_));
+		obj.Set("nativeFunction", rs2_get_failed_function(last_error_));
+
+		return obj;
+	}
+
+	void MarkError(bool may_throw) {
+		if (mode_ == kModeThrow) {
+			if (!may_throw || env_.IsExceptionPending()) return;
+
+			// Left pending rather than thrown in C++, so the failing method still returns its usual fallback value.
+			auto error = Error::New(env_, rs2_get_error_message(last_error_));
+			error.Value().Set("recoverable", IsRecoverable(rs2_get_librealsense_exception_type(last_error_)));
+			error.Value().Set("nativeFunction", rs2_get_failed_function(last_error_));
+			error.ThrowAsJavaScriptException();
+			return;
+		}
+		if (mode_ != kModeCallback || js_error_container_.IsEmpty()) return;
+
 		auto cb = js_error_container_.Get(js_error_callback_name_.c_str()).As<Function>();
-		cb.Call({ GetJSErrorObject(env_) });
+		cb.Call({ GetJSObject(env_) });
 	}
 
-	static ErrorUtil* singleton_;
+	// The instance of the env running on this thread, null on native threads.
+	static thread_local ErrorUtil* current_;
+	static thread_local ErrorUtil* forward_to_;
+	// Where errors of unbound native threads go, the first env to load the addon.
+	static std::shared_ptr<ErrorUtil> fallback_;
 	Env env_;
-	ErrorInfo error_info_;
+	Mode mode_;
+	rs2_error* last_error_;
 	ObjectReference js_error_container_;
 	std::string js_error_callback_name_;
+	std::vector<rs2_error*> forwarded_;
+	std::mutex forward_mutex_;
+	bool closed_;
+	JSThreadSignal signal_;
 };
 
-ErrorUtil* ErrorUtil::singleton_ = nullptr;
+thread_local ErrorUtil* ErrorUtil::current_	   = nullptr;
+thread_local ErrorUtil* ErrorUtil::forward_to_ = nullptr;
+std::shared_ptr<ErrorUtil> ErrorUtil::fallback_;
 
 #endif
@@ -1,60 +1,214 @@
-#ifndef COLORIZER_H
-#define COLORIZER_H
-
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "addon_data.cc"
+#include "frame.cc"
+#include "frame_callbacks.cc"
+#include "frameset.cc"
+#include "options.cc"
+#include "processing_blocks.cc"
+#include "utils.cc"
+#include <deque>
 #include <librealsense2/hpp/rs_types.hpp>
+#include <mutex>
 #include <napi.h>
+#include <string>
+#include <vector>
 
 using namespace Napi;
 
 class RSFilter
-  : public Nan::ObjectWrap
+  : public ObjectWrap<RSFilter>
   , Options {
   public:
-	enum FilterType {
-		kFilterDecimation = 0,
-		kFilterTemporal,
-		kFilterSpatial,
-		kFilterHoleFilling,
-		kFilterDisparity2Depth,
-		kFilterDepth2Disparity
-	};
-	static void Init(v8::Local<v8::Object> exports) {
-		v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
-		tpl->SetClassName(Nan::New("RSFilter").ToLocalChecked());
-		tpl->InstanceTemplate()->SetInternalFieldCount(1);
-
-		Nan::SetPrototypeMethod(tpl, "destroy", Destroy);
-		Nan::SetPrototypeMethod(tpl, "process", Process);
-		Nan::SetPrototypeMethod(tpl, "supportsOption", SupportsOption);
-		Nan::SetPrototypeMethod(tpl, "getOption", GetOption);
-		Nan::SetPrototypeMethod(tpl, "setOption", SetOption);
-		Nan::SetPrototypeMethod(tpl, "getOptionRange", GetOptionRange);
-		Nan::SetPrototypeMethod(tpl, "isOptionReadonly", IsOptionReadonly);
-		Nan::SetPrototypeMethod(tpl, "getOptionDescription", GetOptionDescription);
-		Nan::SetPrototypeMethod(tpl, "getOptionValueDescription", GetOptionValueDescription);
-
-		constructor_.Reset(tpl->GetFunction());
-		exports->Set(Nan::New("RSFilter").ToLocalChecked(), tpl->GetFunction());
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSFilter",
+		  {
+			InstanceMethod("applyOptions", &RSFilter::ApplyOptions),
+			InstanceMethod("destroy", &RSFilter::Destroy),
+			InstanceMethod("getAllOptions", &RSFilter::GetAllOptions),
+			InstanceMethod("getOption", &RSFilter::GetOption),
+			InstanceMethod("getOptionDescription", &RSFilter::GetOptionDescription),
+			InstanceMethod("getOptionRange", &RSFilter::GetOptionRange),
+			InstanceMethod("getOptionValueDescription", &RSFilter::GetOptionValueDescription),
+			InstanceMethod("isOptionReadonly", &RSFilter::IsOptionReadonly),
+			InstanceMethod("process", &RSFilter::Process),
+			InstanceMethod("processAsync", &RSFilter::ProcessAsync),
+			InstanceMethod("processBatch", &RSFilter::ProcessBatch),
+			InstanceMethod("setOption", &RSFilter::SetOption),
+			InstanceMethod("supportsOption", &RSFilter::SupportsOption),
+		  });
+
+		AddonData::SetConstructor<RSFilter>(env, func);
+		exports.Set("RSFilter", func);
+
+		return exports;
 	}
 
 	rs2_options* GetOptionsPointer() override {
 		return reinterpret_cast<rs2_options*>(block_);
 	}
 
-  private:
-	RSFilter()
-	  : block_(nullptr)
+	/**
+	 * info[0] -> One of "decimation", "temporal", "spatial", "hole-filling", "disparity-to-depth"
+	 *            or "depth-to-disparity"
+	 */
+	RSFilter(const CallbackInfo& info)
+	  : ObjectWrap<RSFilter>(info)
+	  , block_(nullptr)
 	  , frame_queue_(nullptr)
 	  , error_(nullptr)
-	  , type_(kFilterDecimation) {
+	  , worker_running_(false) {
+		auto type = info[0].ToString().Utf8Value();
+		if (!type.compare("align") || !type.compare("colorizer") || !type.compare("pointcloud")) {
+			TypeError::New(info.Env(), "Not a filter: " + type).ThrowAsJavaScriptException();
+			return;
+		}
+
+		this->block_ = CreateProcessingBlock(type, RS2_STREAM_ANY, &this->error_);
+		if (!this->block_) {
+			if (!this->error_) TypeError::New(info.Env(), "Unknown filter: " + type).ThrowAsJavaScriptException();
+			return;
+		}
+
+		this->frame_queue_ = GetNativeResult<rs2_frame_queue*>(rs2_create_frame_queue, &this->error_, 1, &this->error_);
+		if (!this->frame_queue_) return;
+
+		auto callback = new FrameCallbackForFrameQueue(this->frame_queue_);
+		CallNativeFunc(rs2_start_processing, &this->error_, this->block_, callback, &this->error_);
 	}
 
 	~RSFilter() {
 		DestroyMe();
 	}
 
+  private:
+	/**
+	 * Runs one or more frames through the filter on the libuv thread pool and settles the promise
+	 * returned by processAsync or processBatch. The worker holds its own reference on every input frame,
+	 * so JS is free to release the inputs as soon as the call returns.
+	 */
+	class ProcessWorker : public AsyncWorker {
+	  public:
+		ProcessWorker(Napi::Env env, RSFilter* filter, Object holder, std::vector<rs2_frame*>&& inputs, bool batch)
+		  : AsyncWorker(env, "RSFilter::ProcessAsync")
+		  , deferred_(Promise::Deferred::New(env))
+		  , holder_(Napi::Persistent(holder))
+		  , filter_(filter)
+		  , inputs_(std::move(inputs))
+		  , outputs_(inputs_.size(), nullptr)
+		  , batch_(batch)
+		  , error_(nullptr) {
+		}
+
+		Napi::Promise GetPromise() const {
+			return deferred_.Promise();
+		}
+
+	  protected:
+		void Execute() override {
+			std::lock_guard<std::mutex> lock(filter_->process_mutex_);
+			for (size_t i = 0; i < inputs_.size(); i++) {
+				auto input = inputs_[i];
+				inputs_[i]	= nullptr;
+				outputs_[i] = filter_->ProcessLocked(input, &error_);
+				if (error_) break;
+			}
+		}
+
+		void OnOK() override {
+			filter_->QueueNextWorker();
+			for (auto input : inputs_)
+				if (input) rs2_release_frame(input);
+
+			if (error_) {
+				for (auto output : outputs_)
+					if (output) rs2_release_frame(output);
+				deferred_.Reject(Error::New(Env(), rs2_get_error_message(error_)).Value());
+				ErrorUtil::AnalyzeRejectedError(error_);
+				return;
+			}
+
+			if (!batch_) {
+				deferred_.Resolve(outputs_[0] ? NewFrameOrFrameSet(Env(), outputs_[0]) : Env().Undefined());
+				return;
+			}
+
+			auto results = Array::New(Env(), outputs_.size());
+			for (uint32_t i = 0; i < outputs_.size(); i++)
+				results.Set(i, outputs_[i] ? Napi::Value(NewFrameOrFrameSet(Env(), outputs_[i])) : Env().Undefined());
+			deferred_.Resolve(results);
+		}
+
+	  private:
+		Promise::Deferred deferred_;
+		ObjectReference holder_;
+		RSFilter* filter_;
+		std::vector<rs2_frame*> inputs_;
+		std::vector<rs2_frame*> outputs_;
+		bool batch_;
+		rs2_error* error_;
+	};
+
+	rs2_processing_block* block_;
+	rs2_frame_queue* frame_queue_;
+	rs2_error* error_;
+	/**
+	 * Calls are served in the order they were made, which stateful filters such as temporal rely on. Async
+	 * calls wait in this FIFO on the JS thread, and only one worker is on the thread pool at a time; the
+	 * next one is queued when the previous one settles.
+	 */
+	std::deque<ProcessWorker*> pending_workers_;
+	bool worker_running_;
+	// Held while the block runs, so destroy() never deletes it under a running worker.
+	std::mutex process_mutex_;
+
+	// JS thread only.
+	void QueueWorker(ProcessWorker* worker) {
+		if (this->worker_running_) {
+			this->pending_workers_.push_back(worker);
+			return;
+		}
+
+		this->worker_running_ = true;
+		worker->Queue();
+	}
+
+	// Called on the JS thread when a worker settles.
+	void QueueNextWorker() {
+		if (this->pending_workers_.empty()) {
+			this->worker_running_ = false;
+			return;
+		}
+
+		auto next = this->pending_workers_.front();
+		this->pending_workers_.pop_front();
+		next->Queue();
+	}
+
+	/**
+	 * Consumes the caller's reference on `input` and returns the filtered frame, or nullptr.
+	 * Must be called with process_mutex_ held; safe on any thread, since it never touches ErrorUtil.
+	 */
+	rs2_frame* ProcessLocked(rs2_frame* input, rs2_error** error) {
+		if (!block_ || !frame_queue_) {
+			rs2_release_frame(input);
+			return nullptr;
+		}
+
+		rs2_process_frame(block_, input, error);
+		if (*error) return nullptr;
+
+		rs2_frame* output = nullptr;
+		rs2_poll_for_frame(frame_queue_, &output, error);
+		return output;
+	}
+
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
+		// Wait out any processing still running on the thread pool.
+		std::lock_guard<std::mutex> lock(process_mutex_);
 		error_ = nullptr;
 		if (block_) rs2_delete_processing_block(block_);
 		block_ = nullptr;
@@ -62,142 +216,133 @@ class RSFilter
 		frame_queue_ = nullptr;
 	}
 
-	static NAN_METHOD(Destroy) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) me->DestroyMe();
-
-		info.GetReturnValue().Set(Nan::Undefined());
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
 	}
 
-	static void New(const Nan::FunctionCallbackInfo<v8::Value>& info) {
-		if (!info.IsConstructCall()) return;
+	// Takes a reference on the frame wrapped by `value` on behalf of a processing call.
+	rs2_frame* AddRefInput(Napi::Value value) {
+		if (!value.IsObject()) return nullptr;
 
-		v8::String::Utf8Value type_str(info[0]);
-		std::string type = std::string(*type_str);
-		RSFilter* obj	= new RSFilter();
-		if (!(type.compare("decimation"))) {
-			obj->type_ = kFilterDecimation;
-			obj->block_
-			  = GetNativeResult<rs2_processing_block*>(rs2_create_decimation_filter_block, &obj->error_, &obj->error_);
-		}
-		else if (!(type.compare("temporal"))) {
-			obj->type_ = kFilterTemporal;
-			obj->block_
-			  = GetNativeResult<rs2_processing_block*>(rs2_create_temporal_filter_block, &obj->error_, &obj->error_);
-		}
-		else if (!(type.compare("spatial"))) {
-			obj->type_ = kFilterSpatial;
-			obj->block_
-			  = GetNativeResult<rs2_processing_block*>(rs2_create_spatial_filter_block, &obj->error_, &obj->error_);
-		}
-		else if (!(type.compare("hole-filling"))) {
-			obj->type_  = kFilterHoleFilling;
-			obj->block_ = GetNativeResult<
-			  rs2_processing_block*>(rs2_create_hole_filling_filter_block, &obj->error_, &obj->error_);
-		}
-		else if (!(type.compare("disparity-to-depth"))) {
-			obj->type_  = kFilterDisparity2Depth;
-			obj->block_ = GetNativeResult<
-			  rs2_processing_block*>(rs2_create_disparity_transform_block, &obj->error_, 0, &obj->error_);
-		}
-		else if (!(type.compare("depth-to-disparity"))) {
-			obj->type_  = kFilterDepth2Disparity;
-			obj->block_ = GetNativeResult<
-			  rs2_processing_block*>(rs2_create_disparity_transform_block, &obj->error_, 1, &obj->error_);
-		}
-		if (!obj->block_) return;
-
-		obj->frame_queue_ = GetNativeResult<rs2_frame_queue*>(rs2_create_frame_queue, &obj->error_, 1, &obj->error_);
-		if (!obj->frame_queue_) return;
-
-		auto callback = new FrameCallbackForFrameQueue(obj->frame_queue_);
-		CallNativeFunc(rs2_start_processing, &obj->error_, obj->block_, callback, &obj->error_);
-		if (obj->error_) return;
+		auto frame = ObjectWrap<RSFrame>::Unwrap(value.ToObject());
+		if (!frame || !frame->frame_) return nullptr;
 
-		obj->Wrap(info.This());
-		info.GetReturnValue().Set(info.This());
+		CallNativeFunc(rs2_frame_add_ref, &this->error_, frame->frame_, &this->error_);
+		return this->error_ ? nullptr : frame->frame_;
 	}
 
-	static NAN_METHOD(Process) {
-		auto me			 = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		auto input_frame = Nan::ObjectWrap::Unwrap<RSFrame>(info[0]->ToObject());
-		auto out_frame   = Nan::ObjectWrap::Unwrap<RSFrame>(info[1]->ToObject());
-		info.GetReturnValue().Set(Nan::False());
-		if (!me || !input_frame || !out_frame) return;
+	Napi::Value Process(const CallbackInfo& info) {
+		auto out_frame = info[1].IsObject() ? ObjectWrap<RSFrame>::Unwrap(info[1].ToObject()) : nullptr;
+		if (!this->block_ || !out_frame) return Boolean::New(info.Env(), false);
 
-		// rs2_process_frame will release the input frame, so we need to addref
-		CallNativeFunc(rs2_frame_add_ref, &me->error_, input_frame->frame_, &me->error_);
-		if (me->error_) return;
+		// Running ahead of queued async calls would reorder the frames a stateful filter sees.
+		if (this->worker_running_) {
+			Error::New(info.Env(), "Async processing pending, await it before calling process()")
+			  .ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
 
-		CallNativeFunc(rs2_process_frame, &me->error_, me->block_, input_frame->frame_, &me->error_);
-		if (me->error_) return;
+		// rs2_process_frame will release the input frame, so we need to addref
+		auto input = this->AddRefInput(info[0]);
+		if (!input) return Boolean::New(info.Env(), false);
 
+		rs2_error* error = nullptr;
 		rs2_frame* frame = nullptr;
-		auto ret_code	= GetNativeResult<int>(rs2_poll_for_frame, &me->error_, me->frame_queue_, &frame, &me->error_);
-		if (!ret_code) return;
+		{
+			std::lock_guard<std::mutex> lock(this->process_mutex_);
+			frame = this->ProcessLocked(input, &error);
+		}
+
+		if (error) ErrorUtil::AnalyzeError(error);
+		if (!frame) return Boolean::New(info.Env(), false);
 
 		out_frame->Replace(frame);
-		info.GetReturnValue().Set(Nan::True());
+		return Boolean::New(info.Env(), true);
 	}
 
-	static NAN_METHOD(SupportsOption) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->SupportsOptionInternal(info);
+	Napi::Value ProcessAsync(const CallbackInfo& info) {
+		auto input = this->block_ ? this->AddRefInput(info[0]) : nullptr;
+		if (!input) {
+			auto deferred = Promise::Deferred::New(info.Env());
+			deferred.Reject(Error::New(info.Env(), this->block_ ? "Expected a frame" : "Filter is destroyed").Value());
+			return deferred.Promise();
+		}
 
-		info.GetReturnValue().Set(Nan::False());
+		std::vector<rs2_frame*> inputs(1, input);
+		auto worker	 = new ProcessWorker(info.Env(), this, info.This().ToObject(), std::move(inputs), false);
+		auto promise = worker->GetPromise();
+		this->QueueWorker(worker);
+		return promise;
 	}
 
-	static NAN_METHOD(GetOption) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->GetOptionInternal(info);
+	/**
+	 * info[0] -> Array of RSFrame, filtered in order with a single trip to the thread pool
+	 */
+	Napi::Value ProcessBatch(const CallbackInfo& info) {
+		std::vector<rs2_frame*> inputs;
+		const char* failure = !this->block_ ? "Filter is destroyed" : !info[0].IsArray() ? "Expected an array of frames"
+																						 : nullptr;
+		if (!failure) {
+			auto frames = info[0].As<Array>();
+			inputs.reserve(frames.Length());
+			for (uint32_t i = 0; i < frames.Length(); i++) {
+				auto input = this->AddRefInput(frames.Get(i));
+				if (!input) {
+					failure = "Expected an array of frames";
+					break;
+				}
+				inputs.push_back(input);
+			}
+		}
+		if (failure) {
+			for (auto input : inputs) rs2_release_frame(input);
+			auto deferred = Promise::Deferred::New(info.Env());
+			deferred.Reject(Error::New(info.Env(), failure).Value());
+			return deferred.Promise();
+		}
 
-		info.GetReturnValue().Set(Nan::Undefined());
+		auto worker	 = new ProcessWorker(info.Env(), this, info.This().ToObject(), std::move(inputs), true);
+		auto promise = worker->GetPromise();
+		this->QueueWorker(worker);
+		return promise;
 	}
 
-	static NAN_METHOD(GetOptionDescription) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->GetOptionDescriptionInternal(info);
-
-		info.GetReturnValue().Set(Nan::Undefined());
+	Napi::Value SupportsOption(const CallbackInfo& info) {
+		return this->SupportsOptionInternal(info);
 	}
 
-	static NAN_METHOD(GetOptionValueDescription) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->GetOptionValueDescriptionInternal(info);
-
-		info.GetReturnValue().Set(Nan::Undefined());
+	Napi::Value GetAllOptions(const CallbackInfo& info) {
+		return this->GetAllOptionsInternal(info);
 	}
 
-	static NAN_METHOD(SetOption) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->SetOptionInternal(info);
-
-		info.GetReturnValue().Set(Nan::Undefined());
+	Napi::Value ApplyOptions(const CallbackInfo& info) {
+		return this->ApplyOptionsInternal(info);
 	}
 
-	static NAN_METHOD(GetOptionRange) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->GetOptionRangeInternal(info);
+	Napi::Value GetOption(const CallbackInfo& info) {
+		return this->GetOptionInternal(info);
+	}
 
-		info.GetReturnValue().Set(Nan::Undefined());
+	Napi::Value GetOptionDescription(const CallbackInfo& info) {
+		return this->GetOptionDescriptionInternal(info);
 	}
 
-	static NAN_METHOD(IsOptionReadonly) {
-		auto me = Nan::ObjectWrap::Unwrap<RSFilter>(info.Holder());
-		if (me) return me->IsOptionReadonlyInternal(info);
+	Napi::Value GetOptionValueDescription(const CallbackInfo& info) {
+		return this->GetOptionValueDescriptionInternal(info);
+	}
 
-		info.GetReturnValue().Set(Nan::False());
+	Napi::Value SetOption(const CallbackInfo& info) {
+		return this->SetOptionInternal(info);
 	}
 
-  private:
-	static Nan::Persistent<v8::Function> constructor_;
+	Napi::Value GetOptionRange(const CallbackInfo& info) {
+		return this->GetOptionRangeInternal(info);
+	}
 
-	rs2_processing_block* block_;
-	rs2_frame_queue* frame_queue_;
-	rs2_error* error_;
-	FilterType type_;
+	Napi::Value IsOptionReadonly(const CallbackInfo& info) {
+		return this->IsOptionReadonlyInternal(info);
+	}
 };
 
-Nan::Persistent<v8::Function> RSFilter::constructor_;
-
 #endif
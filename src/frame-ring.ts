@@ -0,0 +1,158 @@
+import { RSFormat, RSFrameRingHeader, RSFrameSlotHeader, RSStreamType } from './constants';
+
+const RING_HEADER_BYTES = RSFrameRingHeader.Words * 4;
+const SLOT_HEADER_BYTES = RSFrameSlotHeader.Words * 4;
+const RING_MAGIC = 0x52534652;
+
+export interface FrameRingEntry {
+  stream: RSStreamType;
+  streamIndex: number;
+  format: RSFormat;
+  width: number;
+  height: number;
+  stride: number;
+  bitsPerPixel: number;
+  frameNumber: number;
+  timestamp: number;
+  timestampDomain: number;
+  /** The frame data, copied out of the ring */
+  data: Uint8Array;
+}
+
+export interface FrameRingView extends FrameRingEntry {
+  /** Slot the frame lives in */
+  slot: number;
+  /** Slot sequence when the view was taken */
+  sequence: number;
+  /** The frame data, a view into the ring */
+  data: Uint8Array;
+}
+
+/**
+ * Reads the frames an RSFramePublisher writes into a SharedArrayBuffer, from the main thread or from any
+ * worker the buffer was posted to, or the frames an RSFrameBus writes into shared memory, from the
+ * ArrayBuffer an RSFrameBusSubscriber maps in another process. Nothing here needs the native addon.
+ *
+ * <pre><code>
+ *  const buffer = new SharedArrayBuffer(FrameRingReader.byteLength(4, 1280 * 720 * 2));
+ *  new addon.RSFramePublisher().create(new Int32Array(buffer), 4, 1280 * 720 * 2, [RSStreamType.Depth]);
+ *  // in a worker
+ *  const frame = new FrameRingReader(buffer).readLatest();
+ * </code></pre>
+ */
+export class FrameRingReader {
+  /**
+   * Bytes needed by a ring of slotCount slots holding frames of up to slotBytes bytes
+   */
+  static byteLength(slotCount: number, slotBytes: number) {
+    return RING_HEADER_BYTES + slotCount * (SLOT_HEADER_BYTES + FrameRingReader.align(slotBytes));
+  }
+
+  private static align(bytes: number) {
+    return Math.ceil(bytes / 8) * 8;
+  }
+
+  private readonly words: Int32Array;
+  private readonly bytes: Uint8Array;
+  private readonly view: DataView;
+
+  constructor(
+    readonly buffer: SharedArrayBuffer | ArrayBuffer
+  ) {
+    this.words = new Int32Array(buffer);
+    this.bytes = new Uint8Array(buffer);
+    this.view = new DataView(buffer);
+  }
+
+  /**
+   * Whether a publisher has set up the ring yet
+   */
+  get ready() {
+    return Atomics.load(this.words, RSFrameRingHeader.Magic) === RING_MAGIC;
+  }
+
+  /**
+   * Frames published so far, wrapping at 2^32
+   */
+  get published() {
+    return Atomics.load(this.words, RSFrameRingHeader.Published) >>> 0;
+  }
+
+  /**
+   * Frames left out because they did not fit a slot
+   */
+  get skipped() {
+    return Atomics.load(this.words, RSFrameRingHeader.Skipped) >>> 0;
+  }
+
+  /**
+   * Copy the newest frame out of the ring. Returns undefined before the first frame, or when the writer
+   * kept overwriting the slot for every attempt.
+   *
+   * @param {Uint8Array} [out] - receives the frame data when large enough, a new array is made otherwise
+   * @param {number} [attempts] - reads to try before giving up
+   */
+  readLatest(out?: Uint8Array, attempts = 4): FrameRingEntry | undefined {
+    for (let attempt = 0; attempt < attempts; attempt++) {
+      const view = this.viewLatest();
+      if (!view) continue;
+
+      const size = view.data.length;
+      const data = out && out.length >= size ? out.subarray(0, size) : new Uint8Array(size);
+      data.set(view.data);
+      // Unchanged sequence: the writer did not touch the slot while it was copied.
+      if (this.isCurrent(view)) return { ...view, data };
+    }
+
+    return undefined;
+  }
+
+  /**
+   * The newest frame without copying: data is a view into the ring. The writer overwrites the slot after
+   * slotCount - 1 more frames, so check {@link isCurrent} once done with the data, and drop what was read
+   * when it returns false. Returns undefined before the first frame or while the slot is being written.
+   */
+  viewLatest(): FrameRingView | undefined {
+    if (!this.ready) return undefined;
+
+    const slotBytes = Atomics.load(this.words, RSFrameRingHeader.SlotBytes);
+    const slot = Atomics.load(this.words, RSFrameRingHeader.Latest);
+    if (slot < 0) return undefined;
+
+    const base = RING_HEADER_BYTES + slot * (SLOT_HEADER_BYTES + slotBytes);
+    const word = base / 4;
+    const sequence = Atomics.load(this.words, word + RSFrameSlotHeader.Sequence);
+    if (sequence & 1) return undefined;
+
+    const dataSize = this.words[word + RSFrameSlotHeader.DataSize];
+    if (dataSize < 0 || dataSize > slotBytes) return undefined;
+
+    const view: FrameRingView = {
+      slot,
+      sequence,
+      stream: this.words[word + RSFrameSlotHeader.Stream],
+      streamIndex: this.words[word + RSFrameSlotHeader.StreamIndex],
+      format: this.words[word + RSFrameSlotHeader.Format],
+      width: this.words[word + RSFrameSlotHeader.Width],
+      height: this.words[word + RSFrameSlotHeader.Height],
+      stride: this.words[word + RSFrameSlotHeader.Stride],
+      bitsPerPixel: this.words[word + RSFrameSlotHeader.BitsPerPixel],
+      frameNumber: (this.words[word + RSFrameSlotHeader.FrameNumberHigh] >>> 0) * 2 ** 32
+        + (this.words[word + RSFrameSlotHeader.FrameNumberLow] >>> 0),
+      timestamp: this.view.getFloat64(base + RSFrameSlotHeader.Timestamp * 4, true),
+      timestampDomain: this.words[word + RSFrameSlotHeader.TimestampDomain],
+      data: this.bytes.subarray(base + SLOT_HEADER_BYTES, base + SLOT_HEADER_BYTES + dataSize),
+    };
+
+    return this.isCurrent(view) ? view : undefined;
+  }
+
+  /**
+   * Whether the writer left the slot of a view alone since viewLatest() returned it
+   */
+  isCurrent(view: FrameRingView) {
+    const slotBytes = Atomics.load(this.words, RSFrameRingHeader.SlotBytes);
+    const word = (RING_HEADER_BYTES + view.slot * (SLOT_HEADER_BYTES + slotBytes)) / 4;
+    return Atomics.load(this.words, word + RSFrameSlotHeader.Sequence) === view.sequence;
+  }
+}
@@ -1,27 +1,129 @@
 #ifndef FRAME_H
 #define FRAME_H
 
+#include "addon_data.cc"
+#include "depth_kernels.cc"
+#include "frame_view.cc"
 #include "stream_profile.cc"
 #include "utils.cc"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <librealsense2/hpp/rs_types.hpp>
 #include <napi.h>
+#include <utility>
 using namespace Napi;
 
 class RSFrame : public ObjectWrap<RSFrame> {
   public:
+	// The field order of readHeader, mirrored by RSFrameHeader in constants.ts
+	enum HeaderField {
+		kHeaderWidth = 0,
+		kHeaderHeight,
+		kHeaderStrideInBytes,
+		kHeaderBitsPerPixel,
+		kHeaderTimestamp,
+		kHeaderTimestampDomain,
+		kHeaderFrameNumber,
+		kHeaderDataSize,
+		kHeaderStreamType,
+		kHeaderFormat,
+		kHeaderStreamIndex,
+		kHeaderUniqueId,
+		kHeaderFps,
+		kHeaderFieldCount
+	};
+
+	// The flat pose layout of getPoseData(Float32Array), mirrored by RSPoseField in constants.ts
+	enum PoseField {
+		kPoseTranslation		 = 0,
+		kPoseVelocity			 = 3,
+		kPoseAcceleration		 = 6,
+		kPoseRotation			 = 9,
+		kPoseAngularVelocity	 = 13,
+		kPoseAngularAcceleration = 16,
+		kPoseTrackerConfidence	 = 19,
+		kPoseMapperConfidence	 = 20,
+		kPoseFieldCount			 = 21
+	};
+
+	// Bits of the type accessor, one per frame extension, mirrored by RSFrameTypeFlag in constants.ts
+	enum TypeFlag {
+		kTypeVideo	   = 1 << 0,
+		kTypeDepth	   = 1 << 1,
+		kTypeDisparity = 1 << 2,
+		kTypeMotion	   = 1 << 3,
+		kTypePose	   = 1 << 4,
+		kTypePoints	   = 1 << 5,
+		kTypeComposite = 1 << 6
+	};
+
+	// Passed as the type of a frame the caller has not classified yet
+	static const uint32_t kTypeUnclassified = 0xffffffff;
+
+	/**
+	 * Queries every frame extension once. Safe on any thread, a failing query just leaves its bit unset.
+	 */
+	static uint32_t ClassifyFrame(rs2_frame* frame) {
+		static const std::pair<rs2_extension, uint32_t> kExtensions[] = {
+			{ RS2_EXTENSION_VIDEO_FRAME, kTypeVideo },
+			{ RS2_EXTENSION_DEPTH_FRAME, kTypeDepth },
+			{ RS2_EXTENSION_DISPARITY_FRAME, kTypeDisparity },
+			{ RS2_EXTENSION_MOTION_FRAME, kTypeMotion },
+			{ RS2_EXTENSION_POSE_FRAME, kTypePose },
+			{ RS2_EXTENSION_POINTS, kTypePoints },
+			{ RS2_EXTENSION_COMPOSITE_FRAME, kTypeComposite },
+		};
+		if (!frame) return 0;
+
+		uint32_t type = 0;
+		for (const auto& extension : kExtensions) {
+			rs2_error* error = nullptr;
+			if (rs2_is_frame_extendable_to(frame, extension.first, &error) && !error) type |= extension.second;
+			if (error) rs2_free_error(error);
+		}
+		return type;
+	}
+
+	static void WritePose(const rs2_pose& pose, float* out) {
+		memcpy(out + kPoseTranslation, &pose.translation, sizeof(rs2_vector));
+		memcpy(out + kPoseVelocity, &pose.velocity, sizeof(rs2_vector));
+		memcpy(out + kPoseAcceleration, &pose.acceleration, sizeof(rs2_vector));
+		memcpy(out + kPoseRotation, &pose.rotation, sizeof(rs2_quaternion));
+		memcpy(out + kPoseAngularVelocity, &pose.angular_velocity, sizeof(rs2_vector));
+		memcpy(out + kPoseAngularAcceleration, &pose.angular_acceleration, sizeof(rs2_vector));
+		out[kPoseTrackerConfidence] = static_cast<float>(pose.tracker_confidence);
+		out[kPoseMapperConfidence]	= static_cast<float>(pose.mapper_confidence);
+	}
+
+	static void ReadPose(const float* in, rs2_pose* pose) {
+		memcpy(&pose->translation, in + kPoseTranslation, sizeof(rs2_vector));
+		memcpy(&pose->velocity, in + kPoseVelocity, sizeof(rs2_vector));
+		memcpy(&pose->acceleration, in + kPoseAcceleration, sizeof(rs2_vector));
+		memcpy(&pose->rotation, in + kPoseRotation, sizeof(rs2_quaternion));
+		memcpy(&pose->angular_velocity, in + kPoseAngularVelocity, sizeof(rs2_vector));
+		memcpy(&pose->angular_acceleration, in + kPoseAngularAcceleration, sizeof(rs2_vector));
+		pose->tracker_confidence = static_cast<unsigned int>(in[kPoseTrackerConfidence]);
+		pose->mapper_confidence	 = static_cast<unsigned int>(in[kPoseMapperConfidence]);
+	}
+
 	static Object Init(Napi::Env env, Object exports) {
 		Napi::Function func = DefineClass(
 		  env,
 		  "RSFrame",
 		  {
+			InstanceAccessor("type", &RSFrame::Type, nullptr),
 			InstanceMethod("canGetPoints", &RSFrame::CanGetPoints),
 			InstanceMethod("destroy", &RSFrame::Destroy),
 			InstanceMethod("exportToPly", &RSFrame::ExportToPly),
+			InstanceMethod("getAllMetadata", &RSFrame::GetAllMetadata),
 			InstanceMethod("getBaseLine", &RSFrame::GetBaseLine),
 			InstanceMethod("getBitsPerPixel", &RSFrame::GetBitsPerPixel),
 			InstanceMethod("getData", &RSFrame::GetData),
 			InstanceMethod("getDistance", &RSFrame::GetDistance),
+			InstanceMethod("getDistanceGrid", &RSFrame::GetDistanceGrid),
+			InstanceMethod("getDistances", &RSFrame::GetDistances),
 			InstanceMethod("getFrameMetadata", &RSFrame::GetFrameMetadata),
 			InstanceMethod("getFrameNumber", &RSFrame::GetFrameNumber),
 			InstanceMethod("getHeight", &RSFrame::GetHeight),
@@ -44,31 +146,33 @@ class RSFrame : public ObjectWrap<RSFrame> {
 			InstanceMethod("isValid", &RSFrame::IsValid),
 			InstanceMethod("isVideoFrame", &RSFrame::IsVideoFrame),
 			InstanceMethod("keep", &RSFrame::Keep),
+			InstanceMethod("readHeader", &RSFrame::ReadHeader),
 			InstanceMethod("supportsFrameMetadata", &RSFrame::SupportsFrameMetadata),
 			InstanceMethod("writeData", &RSFrame::WriteData),
+			InstanceMethod("writeDepthMeters", &RSFrame::WriteDepthMeters),
 			InstanceMethod("writeTextureCoordinates", &RSFrame::WriteTextureCoordinates),
 			InstanceMethod("writeVertices", &RSFrame::WriteVertices),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSFrame>(env, func);
 		exports.Set("RSFrame", func);
 
 		return exports;
 	}
 
-	static Object NewInstance(Napi::Env env, rs2_frame* frame) {
+	// Callers that already hold the ClassifyFrame() bits pass them as type to skip the extension queries.
+	static Object NewInstance(Napi::Env env, rs2_frame* frame, uint32_t type = kTypeUnclassified) {
 		EscapableHandleScope scope(env);
-		Object instance	  = constructor.New({});
-		auto unwrapped	  = ObjectWrap<RSFrame>::Unwrap(instance);
-		unwrapped->frame_ = frame;
+		Object instance	  = AddonData::Constructor<RSFrame>(env).New({});
+		auto unwrapped	= ObjectWrap<RSFrame>::Unwrap(instance);
+		unwrapped->SetFrame(frame, type);
 
 		return scope.Escape(napi_value(instance)).ToObject();
 	}
 
-	void Replace(rs2_frame* value) {
+	void Replace(rs2_frame* value, uint32_t type = kTypeUnclassified) {
 		DestroyMe();
-		this->frame_ = value;
+		SetFrame(value, type);
 		// As the underlying frame changed, we must clean the js side's buffer
 		// Function::MakeCallback(this, "_internalResetBuffer", 0, nullptr);
 	}
@@ -76,7 +180,9 @@ class RSFrame : public ObjectWrap<RSFrame> {
 	RSFrame(const CallbackInfo& info)
 	  : ObjectWrap<RSFrame>(info)
 	  , frame_(nullptr)
-	  , error_(nullptr) {
+	  , error_(nullptr)
+	  , type_(0)
+	  , depth_units_(0) {
 	}
 
 	~RSFrame() {
@@ -84,11 +190,53 @@ class RSFrame : public ObjectWrap<RSFrame> {
 	}
 
   private:
+	void SetFrame(rs2_frame* frame, uint32_t type) {
+		this->frame_ = frame;
+		this->type_	 = type == kTypeUnclassified ? ClassifyFrame(frame) : type;
+	}
+
 	void DestroyMe() {
-		if (this->error_) rs2_free_error(error_);
 		if (this->frame_) rs2_release_frame(frame_);
-		this->error_ = nullptr;
-		this->frame_ = nullptr;
+		this->error_	   = nullptr;
+		this->frame_	   = nullptr;
+		this->type_		   = 0;
+		this->depth_units_ = 0;
+	}
+
+	/**
+	 * Gives the pixels of a Z16 depth frame, with the stride counted in pixels, or false for any other frame.
+	 */
+	bool GetDepthPixels(const uint16_t** pixels, int* width, int* height, int* stride) {
+		if (!this->frame_) return false;
+
+		if (!(this->type_ & kTypeDepth)) return false;
+		if (GetNativeResult<int>(rs2_get_frame_bits_per_pixel, &this->error_, this->frame_, &this->error_) != 16)
+			return false;
+
+		*pixels = static_cast<const uint16_t*>(
+		  GetNativeResult<const void*>(rs2_get_frame_data, &this->error_, this->frame_, &this->error_));
+		*width	= GetNativeResult<int>(rs2_get_frame_width, &this->error_, this->frame_, &this->error_);
+		*height = GetNativeResult<int>(rs2_get_frame_height, &this->error_, this->frame_, &this->error_);
+		*stride = GetNativeResult<int>(rs2_get_frame_stride_in_bytes, &this->error_, this->frame_, &this->error_) / 2;
+
+		return *pixels && *width > 0 && *height > 0;
+	}
+
+	/**
+	 * Meters per depth unit, looked up once per frame from the depth scale of the sensor that produced it,
+	 * which post-processed frames keep. Returns 0, with the failure reported, when that sensor has none.
+	 */
+	float GetDepthUnits() {
+		if (this->depth_units_ > 0) return this->depth_units_;
+
+		auto sensor = GetNativeResult<rs2_sensor*>(rs2_get_frame_sensor, &this->error_, this->frame_, &this->error_);
+		if (!sensor) return 0;
+
+		this->depth_units_ = GetNativeResult<float>(rs2_get_depth_scale, &this->error_, sensor, &this->error_);
+		rs2_delete_sensor(sensor);
+		if (this->error_ || this->depth_units_ < 0) this->depth_units_ = 0;
+
+		return this->depth_units_;
 	}
 
 	static void SetAFloatInVectorObject(Napi::Env env, Object obj, uint32_t index, float value) {
@@ -138,11 +286,7 @@ class RSFrame : public ObjectWrap<RSFrame> {
 	}
 
 	Napi::Value CanGetPoints(const CallbackInfo& info) {
-		bool result = false;
-		if (GetNativeResult<
-			  int>(rs2_is_frame_extendable_to, &this->error_, this->frame_, RS2_EXTENSION_POINTS, &this->error_))
-			result = true;
-		return Boolean::New(info.Env(), result);
+		return Boolean::New(info.Env(), (this->type_ & kTypePoints) != 0);
 	}
 
 	Napi::Value Destroy(const CallbackInfo& info) {
@@ -176,12 +320,10 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		auto buffer = GetNativeResult<const void*>(rs2_get_frame_data, &this->error_, this->frame_, &this->error_);
 		if (!buffer) return info.Env().Undefined();
 
-		const auto stride
-		  = GetNativeResult<int>(rs2_get_frame_stride_in_bytes, &this->error_, this->frame_, &this->error_);
-		const auto height = GetNativeResult<int>(rs2_get_frame_height, &this->error_, this->frame_, &this->error_);
-		const auto length = stride * height;
-		auto array_buffer = ArrayBuffer::New(info.Env(), static_cast<uint8_t*>(const_cast<void*>(buffer)), length);
-		return TypedArrayOf<uint8_t>::New(info.Env(), length, array_buffer, 0);
+		const auto length = GetNativeResult<int>(rs2_get_frame_data_size, &this->error_, this->frame_, &this->error_);
+		if (length <= 0) return info.Env().Undefined();
+
+		return FrameView::NewTypedArray<uint8_t>(info.Env(), this->frame_, buffer, length);
 	}
 
 	Napi::Value GetDistance(const CallbackInfo& info) {
@@ -193,6 +335,139 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		return Number::New(info.Env(), val);
 	}
 
+	/**
+	 * info[0] -> Number of pixels between samples along x
+	 * info[1] -> Number of pixels between samples along y
+	 * info[2] -> Float32Array receiving the distances in meters, row by row
+	 *
+	 * Samples columns 0, stepX, 2 * stepX... of rows 0, stepY, 2 * stepY... and returns the sample count,
+	 * or 0 when the frame is not a depth frame, its sensor has no depth scale or the output is too small.
+	 */
+	Napi::Value GetDistanceGrid(const CallbackInfo& info) {
+		const uint16_t* pixels = nullptr;
+		int width = 0, height = 0, stride = 0;
+		auto step_x = std::max(info[0].ToNumber().Int32Value(), 1);
+		auto step_y = std::max(info[1].ToNumber().Int32Value(), 1);
+		if (!ExpectTypedArray(info[2], napi_float32_array, "Float32Array for the distances"))
+			return info.Env().Undefined();
+		if (!this->GetDepthPixels(&pixels, &width, &height, &stride)) return Number::New(info.Env(), 0);
+
+		auto out	   = info[2].As<Float32Array>();
+		const int cols = (width + step_x - 1) / step_x;
+		const int rows = (height + step_y - 1) / step_y;
+		if (out.ElementLength() < static_cast<size_t>(cols) * rows) return Number::New(info.Env(), 0);
+
+		const float units = this->GetDepthUnits();
+		if (!units) return Number::New(info.Env(), 0);
+
+		float* dst = out.Data();
+		for (int y = 0; y < height; y += step_y, dst += cols) {
+			const uint16_t* row = pixels + y * stride;
+			if (step_x == 1) {
+				// Contiguous rows are left in a form the compiler vectorizes.
+				for (int x = 0; x < cols; x++) dst[x] = row[x] * units;
+			}
+			else {
+				for (int x = 0; x < cols; x++) dst[x] = row[x * step_x] * units;
+			}
+		}
+
+		return Number::New(info.Env(), cols * rows);
+	}
+
+	/**
+	 * info[0] -> Int32Array of x, y pairs
+	 * info[1] -> Float32Array receiving one distance in meters per pair, NaN for pairs outside the frame
+	 *
+	 * Returns the number of distances written, 0 when the frame is not a depth frame or its sensor has no
+	 * depth scale.
+	 */
+	Napi::Value GetDistances(const CallbackInfo& info) {
+		const uint16_t* pixels = nullptr;
+		int width = 0, height = 0, stride = 0;
+		if (!ExpectTypedArray(info[0], napi_int32_array, "Int32Array of coordinates")
+			|| !ExpectTypedArray(info[1], napi_float32_array, "Float32Array for the distances"))
+			return info.Env().Undefined();
+		if (!this->GetDepthPixels(&pixels, &width, &height, &stride)) return Number::New(info.Env(), 0);
+
+		auto coords		  = info[0].As<Int32Array>();
+		auto out		  = info[1].As<Float32Array>();
+		const size_t n	  = std::min(coords.ElementLength() / 2, out.ElementLength());
+		const float units = this->GetDepthUnits();
+		if (!units) return Number::New(info.Env(), 0);
+
+		const int32_t* xy = coords.Data();
+		float* dst		  = out.Data();
+		for (size_t i = 0; i < n; i++) {
+			const int32_t x = xy[2 * i];
+			const int32_t y = xy[2 * i + 1];
+			// The unsigned compare also rejects negative coordinates.
+			dst[i] = static_cast<uint32_t>(x) < static_cast<uint32_t>(width)
+					   && static_cast<uint32_t>(y) < static_cast<uint32_t>(height)
+					 ? pixels[y * stride + x] * units
+					 : NAN;
+		}
+
+		return Number::New(info.Env(), static_cast<double>(n));
+	}
+
+	/**
+	 * info[0] -> BigInt64Array of at least addon.frameMetadataCount elements, indexed by metadata key. A
+	 *            Float64Array is accepted too, for runtimes without BigInt.
+	 * info[1] -> Uint32Array with one bit per key, set when the frame carries that key
+	 *
+	 * Every supported key is fetched in one call. Unsupported keys, and keys librealsense fails to read, read
+	 * as 0 with their mask bit clear. Returns the number of keys present, or -1 when the frame is empty or an
+	 * output is too small. Throws a TypeError for a mask that is not a Uint32Array.
+	 */
+	Napi::Value GetAllMetadata(const CallbackInfo& info) {
+		const size_t mask_words = (RS2_FRAME_METADATA_COUNT + 31) / 32;
+		if (!ExpectTypedArray(info[1], napi_uint32_array, "Uint32Array for the metadata mask"))
+			return info.Env().Undefined();
+		if (!this->frame_ || !info[0].IsTypedArray()) return Number::New(info.Env(), -1);
+
+		auto values = info[0].As<TypedArray>();
+		auto type	= values.TypedArrayType();
+		auto mask	= info[1].As<Uint32Array>();
+		if (
+		  (type != napi_bigint64_array && type != napi_float64_array)
+		  || values.ElementLength() < RS2_FRAME_METADATA_COUNT || mask.ElementLength() < mask_words)
+			return Number::New(info.Env(), -1);
+
+		auto bytes		= static_cast<uint8_t*>(values.ArrayBuffer().Data()) + values.ByteOffset();
+		auto as_int64	= reinterpret_cast<int64_t*>(bytes);
+		auto as_double	= reinterpret_cast<double*>(bytes);
+		uint32_t* bits	= mask.Data();
+		int32_t present = 0;
+		std::fill(bits, bits + mask_words, 0);
+
+		// Native byte order all the way through, so JS reads the values as they are.
+		for (int32_t key = 0; key < RS2_FRAME_METADATA_COUNT; key++) {
+			auto metadata			= static_cast<rs2_frame_metadata_value>(key);
+			rs2_metadata_type value = 0;
+			rs2_error* error		= nullptr;
+			bool read				= false;
+			if (rs2_supports_frame_metadata(this->frame_, metadata, &error) && !error) {
+				value = rs2_get_frame_metadata(this->frame_, metadata, &error);
+				read  = !error;
+			}
+			// A key that fails to read is left out, the remaining keys are still filled in.
+			if (error) rs2_free_error(error);
+			if (read) {
+				bits[key / 32] |= 1u << (key % 32);
+				present++;
+			}
+			else
+				value = 0;
+
+			if (type == napi_bigint64_array)
+				as_int64[key] = value;
+			else
+				as_double[key] = static_cast<double>(value);
+		}
+		return Number::New(info.Env(), present);
+	}
+
 	Napi::Value GetFrameMetadata(const CallbackInfo& info) {
 		rs2_frame_metadata_value metadata = static_cast<rs2_frame_metadata_value>(info[0].ToNumber().Int32Value());
 		TypedArrayOf<unsigned char> content(info.Env(), info[1]);
@@ -240,40 +515,38 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		return Number::New(info.Env(), count);
 	}
 
+	/**
+	 * info[0] -> Either an RSPose object, or a Float32Array of at least RSPoseField.Count elements which
+	 *            receives the pose without creating any JS value
+	 */
 	Napi::Value GetPoseData(const CallbackInfo& info) {
+		auto flat = info[0].IsTypedArray();
+		if (flat && !ExpectTypedArray(info[0], napi_float32_array, "Float32Array for the pose"))
+			return info.Env().Undefined();
+		if (flat && info[0].As<Float32Array>().ElementLength() < kPoseFieldCount)
+			return Boolean::New(info.Env(), false);
+
 		rs2_pose pose_data;
 		CallNativeFunc(rs2_pose_frame_get_pose_data, &this->error_, this->frame_, &pose_data, &this->error_);
 		if (this->error_) return Boolean::New(info.Env(), false);
 
-		AssemblePoseData(info.Env(), info[0].ToObject(), pose_data);
+		if (flat)
+			WritePose(pose_data, info[0].As<Float32Array>().Data());
+		else
+			AssemblePoseData(info.Env(), info[0].ToObject(), pose_data);
 		return Boolean::New(info.Env(), true);
 	}
 
+	// Frames of the same stream share one interned RSStreamProfile.
 	Napi::Value GetStreamProfile(const CallbackInfo& info) {
-		rs2_stream stream;
-		rs2_format format;
-		int32_t index						  = 0;
-		int32_t unique_id					  = 0;
-		int32_t fps							  = 0;
-		const rs2_stream_profile* profile_org = GetNativeResult<
+		auto profile = GetNativeResult<
 		  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &this->error_, this->frame_, &this->error_);
-		CallNativeFunc(
-		  rs2_get_stream_profile_data,
-		  &this->error_,
-		  profile_org,
-		  &stream,
-		  &format,
-		  &index,
-		  &unique_id,
-		  &fps,
-		  &this->error_);
-		if (this->error_) return info.Env().Undefined();
-
-		rs2_stream_profile* profile = GetNativeResult<
-		  rs2_stream_profile*>(rs2_clone_stream_profile, &this->error_, profile_org, stream, index, format, &this->error_);
 		if (!profile) return info.Env().Undefined();
 
-		return RSStreamProfile::NewInstance(info.Env(), profile, true);
+		auto instance = RSStreamProfile::Intern(info.Env(), profile);
+		if (instance.IsEmpty()) return info.Env().Undefined();
+
+		return instance;
 	}
 
 	Napi::Value GetStrideInBytes(const CallbackInfo& info) {
@@ -295,14 +568,8 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		size_t count = GetNativeResult<size_t>(rs2_get_frame_points_count, &this->error_, this->frame_, &this->error_);
 		if (!coords || !count) return info.Env().Undefined();
 
-		uint32_t step	  = 2 * sizeof(int);
-		uint32_t len	  = count * step;
-		auto texcoord_buf = static_cast<uint8_t*>(malloc(len));
-
-		for (size_t i = 0; i < count; ++i) { memcpy(texcoord_buf + i * step, coords[i].ij, step); }
-		auto array_buffer = ArrayBuffer::New(info.Env(), texcoord_buf, len);
-
-		return TypedArrayOf<float>::New(info.Env(), 2 * count, array_buffer, 0);
+		// The pointcloud block stores float (u, v) pairs in the rs2_pixel slots, so they are viewed as-is.
+		return FrameView::NewTypedArray<float>(info.Env(), this->frame_, coords, 2 * count);
 	}
 
 	Napi::Value GetTimestamp(const CallbackInfo& info) {
@@ -322,13 +589,7 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		size_t count = GetNativeResult<size_t>(rs2_get_frame_points_count, &this->error_, this->frame_, &this->error_);
 		if (!vertices || !count) return info.Env().Undefined();
 
-		uint32_t step	= 3 * sizeof(float);
-		uint32_t len	= count * step;
-		auto vertex_buf = static_cast<uint8_t*>(malloc(len));
-
-		for (size_t i = 0; i < count; i++) { memcpy(vertex_buf + i * step, vertices[i].xyz, step); }
-		auto array_buffer = ArrayBuffer::New(info.Env(), vertex_buf, len);
-		return TypedArrayOf<float>::New(info.Env(), 3 * count, array_buffer, 0);
+		return FrameView::NewTypedArray<float>(info.Env(), this->frame_, vertices, 3 * count);
 	}
 
 	Napi::Value GetVerticesBufferLen(const CallbackInfo& info) {
@@ -345,29 +606,19 @@ class RSFrame : public ObjectWrap<RSFrame> {
 	}
 
 	Napi::Value IsDepthFrame(const CallbackInfo& info) {
-		bool isDepth = false;
-		if (GetNativeResult<
-			  bool>(rs2_is_frame_extendable_to, &this->error_, this->frame_, RS2_EXTENSION_DEPTH_FRAME, &this->error_))
-			isDepth = true;
-		return Boolean::New(info.Env(), isDepth);
+		return Boolean::New(info.Env(), (this->type_ & kTypeDepth) != 0);
 	}
 
 	Napi::Value IsDisparityFrame(const CallbackInfo& info) {
-		auto is_disparity = GetNativeResult<
-		  int>(rs2_is_frame_extendable_to, &this->error_, this->frame_, RS2_EXTENSION_DISPARITY_FRAME, &this->error_);
-		return Boolean::New(info.Env(), is_disparity ? true : false);
+		return Boolean::New(info.Env(), (this->type_ & kTypeDisparity) != 0);
 	}
 
 	Napi::Value IsMotionFrame(const CallbackInfo& info) {
-		auto val = GetNativeResult<
-		  int>(rs2_is_frame_extendable_to, &this->error_, this->frame_, RS2_EXTENSION_MOTION_FRAME, &this->error_);
-		return Boolean::New(info.Env(), val ? true : false);
+		return Boolean::New(info.Env(), (this->type_ & kTypeMotion) != 0);
 	}
 
 	Napi::Value IsPoseFrame(const CallbackInfo& info) {
-		auto val = GetNativeResult<
-		  int>(rs2_is_frame_extendable_to, &this->error_, this->frame_, RS2_EXTENSION_POSE_FRAME, &this->error_);
-		return Boolean::New(info.Env(), val ? true : false);
+		return Boolean::New(info.Env(), (this->type_ & kTypePose) != 0);
 	}
 
 	Napi::Value IsValid(const CallbackInfo& info) {
@@ -375,11 +626,7 @@ class RSFrame : public ObjectWrap<RSFrame> {
 	}
 
 	Napi::Value IsVideoFrame(const CallbackInfo& info) {
-		bool isVideo = false;
-		if (GetNativeResult<
-			  bool>(rs2_is_frame_extendable_to, &this->error_, this->frame_, RS2_EXTENSION_VIDEO_FRAME, &this->error_))
-			isVideo = true;
-		return Boolean::New(info.Env(), isVideo);
+		return Boolean::New(info.Env(), (this->type_ & kTypeVideo) != 0);
 	}
 
 	Napi::Value Keep(const CallbackInfo& info) {
@@ -397,6 +644,11 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		return Boolean::New(info.Env(), result ? true : false);
 	}
 
+	// The TypeFlag bitmask of the frame, 0 once it is destroyed
+	Napi::Value Type(const CallbackInfo& info) {
+		return Number::New(info.Env(), this->type_);
+	}
+
 	Napi::Value WriteData(const CallbackInfo& info) {
 		auto array_buffer = info[0].As<ArrayBuffer>();
 
@@ -410,10 +662,104 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		return info.This();
 	}
 
+	/**
+	 * info[0] -> Float64Array of at least RSFrameHeader.Count elements
+	 *
+	 * Fills every scalar property of the frame and its stream profile in one call, with a single error
+	 * check at the end instead of one per property. Returns false when the frame is empty, the output is
+	 * too small or librealsense failed, and throws a TypeError for any other kind of array.
+	 */
+	Napi::Value ReadHeader(const CallbackInfo& info) {
+		if (!ExpectTypedArray(info[0], napi_float64_array, "Float64Array for the header"))
+			return info.Env().Undefined();
+		if (!this->frame_) return Boolean::New(info.Env(), false);
+
+		auto out = info[0].As<Float64Array>();
+		if (out.ElementLength() < kHeaderFieldCount) return Boolean::New(info.Env(), false);
+
+		double* header = out.Data();
+		std::fill(header, header + kHeaderFieldCount, 0);
+
+		// Calls run until the first failure; the rest of the header is left at zero.
+		rs2_error* error = nullptr;
+		ErrorUtil::ResetError();
+		auto frame = this->frame_;
+		if (this->type_ & kTypeVideo) {
+			header[kHeaderWidth] = rs2_get_frame_width(frame, &error);
+			if (!error) header[kHeaderHeight] = rs2_get_frame_height(frame, &error);
+			if (!error) header[kHeaderStrideInBytes] = rs2_get_frame_stride_in_bytes(frame, &error);
+			if (!error) header[kHeaderBitsPerPixel] = rs2_get_frame_bits_per_pixel(frame, &error);
+		}
+		if (!error) header[kHeaderTimestamp] = rs2_get_frame_timestamp(frame, &error);
+		if (!error) header[kHeaderTimestampDomain] = rs2_get_frame_timestamp_domain(frame, &error);
+		if (!error) header[kHeaderFrameNumber] = static_cast<double>(rs2_get_frame_number(frame, &error));
+		if (!error) header[kHeaderDataSize] = rs2_get_frame_data_size(frame, &error);
+
+		const rs2_stream_profile* profile = nullptr;
+		if (!error) profile = rs2_get_frame_stream_profile(frame, &error);
+		if (!error && profile) {
+			rs2_stream stream = RS2_STREAM_ANY;
+			rs2_format format = RS2_FORMAT_ANY;
+			int index = 0, unique_id = 0, fps = 0;
+			rs2_get_stream_profile_data(profile, &stream, &format, &index, &unique_id, &fps, &error);
+			header[kHeaderStreamType]  = stream;
+			header[kHeaderFormat]	   = format;
+			header[kHeaderStreamIndex] = index;
+			header[kHeaderUniqueId]	   = unique_id;
+			header[kHeaderFps]		   = fps;
+		}
+
+		if (!error) return Boolean::New(info.Env(), true);
+
+		ErrorUtil::AnalyzeError(error);
+		return Boolean::New(info.Env(), false);
+	}
+
+	/**
+	 * info[0] -> Float32Array receiving the depth in meters
+	 * info[1] -> Optional meters per depth unit, default to the depth scale of the frame's sensor
+	 * info[2] -> Optional region of interest x, default to 0
+	 * info[3] -> Optional region of interest y, default to 0
+	 * info[4] -> Optional region of interest width, default to the rest of the frame
+	 * info[5] -> Optional region of interest height, default to the rest of the frame
+	 * info[6] -> Optional distance between output rows in elements, default to the region width
+	 */
+	Napi::Value WriteDepthMeters(const CallbackInfo& info) {
+		const uint16_t* pixels = nullptr;
+		int width = 0, height = 0, stride = 0;
+		if (!ExpectTypedArray(info[0], napi_float32_array, "Float32Array for the meters"))
+			return info.Env().Undefined();
+		if (!info[1].IsUndefined() && (!info[1].IsNumber() || !std::isfinite(info[1].As<Number>().DoubleValue()))) {
+			TypeError::New(info.Env(), "Expected a finite depth scale").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+		if (!this->GetDepthPixels(&pixels, &width, &height, &stride)) return Boolean::New(info.Env(), false);
+
+		auto x		   = info[2].IsNumber() ? info[2].ToNumber().Int32Value() : 0;
+		auto y		   = info[3].IsNumber() ? info[3].ToNumber().Int32Value() : 0;
+		auto roi_w	   = info[4].IsNumber() ? info[4].ToNumber().Int32Value() : width - x;
+		auto roi_h	   = info[5].IsNumber() ? info[5].ToNumber().Int32Value() : height - y;
+		auto out_pitch = info[6].IsNumber() ? info[6].ToNumber().Int32Value() : roi_w;
+		if (x < 0 || y < 0 || roi_w <= 0 || roi_h <= 0 || x + roi_w > width || y + roi_h > height || out_pitch < roi_w)
+			return Boolean::New(info.Env(), false);
+
+		auto out = info[0].As<Float32Array>();
+		if (out.ElementLength() < static_cast<size_t>(out_pitch) * (roi_h - 1) + roi_w)
+			return Boolean::New(info.Env(), false);
+
+		const float scale = info[1].IsNumber() ? info[1].ToNumber().FloatValue() : this->GetDepthUnits();
+		if (!scale) return Boolean::New(info.Env(), false);
+
+		DepthKernels::DepthToMeters2D(pixels + y * stride + x, stride, roi_w, roi_h, scale, out.Data(), out_pitch);
+
+		return Boolean::New(info.Env(), true);
+	}
+
 	Napi::Value WriteTextureCoordinates(const CallbackInfo& info) {
 		auto array_buffer = info[0].As<ArrayBuffer>();
 
-		const rs2_pixel* coords = rs2_get_frame_texture_coordinates(this->frame_, &this->error_);
+		const rs2_pixel* coords = GetNativeResult<
+		  const rs2_pixel*>(rs2_get_frame_texture_coordinates, &this->error_, this->frame_, &this->error_);
 		const size_t count
 		  = GetNativeResult<size_t>(rs2_get_frame_points_count, &this->error_, this->frame_, &this->error_);
 		if (!coords || !count) return Boolean::New(info.Env(), false);
@@ -422,8 +768,7 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		const uint32_t length = count * step;
 		if (array_buffer.ByteLength() < length) return Boolean::New(info.Env(), false);
 
-		uint8_t* texcoord_buf = static_cast<uint8_t*>(array_buffer.Data());
-		for (size_t i = 0; i < count; ++i) { memcpy(texcoord_buf + i * step, coords[i].ij, step); }
+		memcpy(array_buffer.Data(), coords, length);
 		return Boolean::New(info.Env(), true);
 	}
 
@@ -440,22 +785,22 @@ class RSFrame : public ObjectWrap<RSFrame> {
 		const uint32_t length = count * step;
 		if (array_buffer.ByteLength() < length) return Boolean::New(info.Env(), false);
 
-		uint8_t* vertex_buf = static_cast<uint8_t*>(array_buffer.Data());
-		for (size_t i = 0; i < count; i++) { memcpy(vertex_buf + i * step, vertBuf[i].xyz, step); }
+		memcpy(array_buffer.Data(), vertBuf, length);
 		return Boolean::New(info.Env(), true);
 	}
 
   private:
-	static FunctionReference constructor;
 	rs2_frame* frame_;
 	rs2_error* error_;
+	// TypeFlag bits of frame_, classified whenever the frame is set
+	uint32_t type_;
+	float depth_units_;
 	friend class RSColorizer;
 	friend class RSFilter;
 	friend class RSFrameQueue;
 	friend class RSPointCloud;
+	friend class RSPoseHistory;
 	friend class RSSyncer;
 };
 
-Napi::FunctionReference RSFrame::constructor;
-
 #endif
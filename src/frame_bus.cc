@@ -0,0 +1,421 @@
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include "addon_data.cc"
+#include "frame_publisher.cc"
+#include "utils.cc"
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace Napi;
+
+/**
+ * A POSIX shared memory object mapped into this process, unmapped once the last holder lets go.
+ * The creator also unlinks the name then; processes that still have it mapped keep their mapping.
+ */
+class SharedMemory {
+  public:
+	// Names follow shm_open, a leading slash is added when missing.
+	static std::string NormalizeName(const std::string& name) {
+		return !name.empty() && name[0] == '/' ? name : "/" + name;
+	}
+
+	static std::shared_ptr<SharedMemory> Create(const std::string& name, size_t length, std::string* failure) {
+		auto normalized = NormalizeName(name);
+		int fd			= shm_open(normalized.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0) return Fail("shm_open", failure);
+		if (ftruncate(fd, static_cast<off_t>(length)) < 0) {
+			auto memory = Fail("ftruncate", failure);
+			close(fd);
+			shm_unlink(normalized.c_str());
+			return memory;
+		}
+
+		return Map(fd, normalized, length, true, failure);
+	}
+
+	static std::shared_ptr<SharedMemory> Open(const std::string& name, std::string* failure) {
+		auto normalized = NormalizeName(name);
+		int fd			= shm_open(normalized.c_str(), O_RDWR, 0);
+		if (fd < 0) return Fail("shm_open", failure);
+
+		struct stat info;
+		if (fstat(fd, &info) < 0) {
+			close(fd);
+			return Fail("fstat", failure);
+		}
+
+		return Map(fd, normalized, static_cast<size_t>(info.st_size), false, failure);
+	}
+
+	// Returns false when there is no object of that name.
+	static bool Unlink(const std::string& name, std::string* failure) {
+		if (shm_unlink(NormalizeName(name).c_str()) == 0) return true;
+		if (errno != ENOENT) Fail("shm_unlink", failure);
+
+		return false;
+	}
+
+	SharedMemory(uint8_t* data, size_t length, const std::string& name, bool owner)
+	  : data_(data)
+	  , length_(length)
+	  , name_(name)
+	  , owner_(owner) {
+	}
+
+	~SharedMemory() {
+		munmap(data_, length_);
+		if (owner_) shm_unlink(name_.c_str());
+	}
+
+	uint8_t* Data() const {
+		return data_;
+	}
+
+	size_t Length() const {
+		return length_;
+	}
+
+  private:
+	static std::shared_ptr<SharedMemory> Fail(const char* call, std::string* failure) {
+		*failure = std::string(call) + ": " + strerror(errno);
+		return nullptr;
+	}
+
+	static std::shared_ptr<SharedMemory> Map(
+	  int fd, const std::string& name, size_t length, bool owner, std::string* failure) {
+		void* data = length ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		auto memory
+		  = data == MAP_FAILED ? Fail("mmap", failure)
+							   : std::make_shared<SharedMemory>(static_cast<uint8_t*>(data), length, name, owner);
+		// The mapping stays valid without the descriptor.
+		close(fd);
+		if (!memory && owner) shm_unlink(name.c_str());
+
+		return memory;
+	}
+
+	uint8_t* data_;
+	size_t length_;
+	std::string name_;
+	bool owner_;
+};
+
+/**
+ * Blocking on the published count of a ring that other processes write. On Linux this is a shared futex,
+ * woken by the writer only while some reader is registered as waiting; elsewhere readers poll.
+ */
+class RingNotifier {
+  public:
+	static void WakeAll(uint8_t* ring) {
+		if (FrameRing::Word(ring, FrameRing::kRingWaiters).load(std::memory_order_seq_cst) <= 0) return;
+
+#ifdef __linux__
+		syscall(SYS_futex, &FrameRing::Word(ring, FrameRing::kRingPublished), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+	}
+
+	// Returns the published count once it differs from seen, or seen after the timeout.
+	static int32_t Wait(uint8_t* ring, int32_t seen, uint32_t timeout_ms) {
+		auto& published = FrameRing::Word(ring, FrameRing::kRingPublished);
+		auto& waiters	= FrameRing::Word(ring, FrameRing::kRingWaiters);
+		auto deadline	= std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		int32_t current = published.load(std::memory_order_seq_cst);
+		while (current == seen) {
+			auto now = std::chrono::steady_clock::now();
+			if (now >= deadline) break;
+
+#ifdef __linux__
+			auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+			struct timespec timeout = { static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000) };
+			// Returns at once if the count already moved on, so no wake-up can be missed.
+			syscall(SYS_futex, &published, FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+			current = published.load(std::memory_order_seq_cst);
+		}
+		waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+		return current;
+	}
+};
+
+/**
+ * Publishes the frames of a pipeline or sensor into a frame ring in POSIX shared memory, which processes on
+ * the same host read with RSFrameBusSubscriber. Only the process that opens the device needs librealsense
+ * to stream; the others only map the ring.
+ */
+class RSFrameBus : public ObjectWrap<RSFrameBus> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSFrameBus",
+		  {
+			InstanceMethod("create", &RSFrameBus::Create),
+			InstanceMethod("destroy", &RSFrameBus::Destroy),
+			StaticMethod("unlink", &RSFrameBus::Unlink),
+		  });
+
+		AddonData::SetConstructor<RSFrameBus>(env, func);
+		exports.Set("RSFrameBus", func);
+
+		return exports;
+	}
+
+	RSFrameBus(const CallbackInfo& info)
+	  : ObjectWrap<RSFrameBus>(info) {
+	}
+
+	~RSFrameBus() {
+		DestroyMe();
+	}
+
+  private:
+	friend class RSPipeline;
+	friend class RSSensor;
+
+	std::shared_ptr<FrameRing> ring_;
+
+	// The shared memory goes away with the ring, once no callback holds it any more.
+	void DestroyMe() {
+		if (ring_) ring_->Close();
+		ring_ = nullptr;
+	}
+
+	/**
+	 * info[0] -> Name of the shared memory object, which must not exist yet. A process that dies without
+	 *            destroy() leaves its object behind, and creating the name again then fails with EEXIST
+	 *            until RSFrameBus.unlink() removes it.
+	 * info[1] -> Slot count, at least 2
+	 * info[2] -> Largest frame data size in bytes a slot holds; larger frames are counted and left out
+	 * info[3] -> Optional array of RSStreamType to publish, all streams when missing or empty
+	 */
+	Napi::Value Create(const CallbackInfo& info) {
+		auto name		= info[0].IsString() ? info[0].ToString().Utf8Value() : std::string();
+		auto slot_count = info[1].IsNumber() ? info[1].ToNumber().Uint32Value() : 0;
+		auto slot_bytes = info[2].IsNumber() ? info[2].ToNumber().Uint32Value() : 0;
+		if (name.empty() || slot_count < 2 || !slot_bytes) {
+			TypeError::New(info.Env(), "Expected a name, at least 2 slots and a slot size")
+			  .ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		std::vector<rs2_stream> streams;
+		if (info[3].IsArray()) {
+			auto list = info[3].As<Array>();
+			for (uint32_t i = 0; i < list.Length(); i++)
+				streams.push_back(static_cast<rs2_stream>(list.Get(i).ToNumber().Int32Value()));
+		}
+
+		this->DestroyMe();
+		std::string failure;
+		auto memory = SharedMemory::Create(name, FrameRing::ByteLength(slot_count, slot_bytes), &failure);
+		if (!memory) {
+			Error::New(info.Env(), failure).ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		auto data	= memory->Data();
+		this->ring_ = std::make_shared<FrameRing>(
+		  data, slot_count, slot_bytes, streams, memory, [data] { RingNotifier::WakeAll(data); });
+		return info.This();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> Name of a shared memory object left behind, e.g. by a publisher that crashed
+	 *
+	 * Returns whether an object was removed. Subscribers that have it mapped keep their mapping.
+	 */
+	static Napi::Value Unlink(const CallbackInfo& info) {
+		auto name = info[0].IsString() ? info[0].ToString().Utf8Value() : std::string();
+		if (name.empty()) {
+			TypeError::New(info.Env(), "Expected a name").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		std::string failure;
+		auto removed = SharedMemory::Unlink(name, &failure);
+		if (!failure.empty()) {
+			Error::New(info.Env(), failure).ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		return Boolean::New(info.Env(), removed);
+	}
+};
+
+/**
+ * Maps the ring of an RSFrameBus created by another process. getBuffer() hands out the whole mapping as an
+ * ArrayBuffer without copying, to read with FrameRingReader.
+ */
+class RSFrameBusSubscriber : public ObjectWrap<RSFrameBusSubscriber> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSFrameBusSubscriber",
+		  {
+			InstanceMethod("destroy", &RSFrameBusSubscriber::Destroy),
+			InstanceMethod("getBuffer", &RSFrameBusSubscriber::GetBuffer),
+			InstanceMethod("open", &RSFrameBusSubscriber::Open),
+			InstanceMethod("waitForFrame", &RSFrameBusSubscriber::WaitForFrame),
+			InstanceMethod("waitForFrameAsync", &RSFrameBusSubscriber::WaitForFrameAsync),
+		  });
+
+		AddonData::SetConstructor<RSFrameBusSubscriber>(env, func);
+		exports.Set("RSFrameBusSubscriber", func);
+
+		return exports;
+	}
+
+	RSFrameBusSubscriber(const CallbackInfo& info)
+	  : ObjectWrap<RSFrameBusSubscriber>(info) {
+	}
+
+	~RSFrameBusSubscriber() {
+		DestroyMe();
+	}
+
+  private:
+	// Waits on the libuv thread pool, holding the mapping so destroy() cannot pull it away meanwhile.
+	class WaitForFrameWorker : public AsyncWorker {
+	  public:
+		WaitForFrameWorker(Napi::Env env, std::shared_ptr<SharedMemory> memory, int32_t seen, uint32_t timeout)
+		  : AsyncWorker(env, "RSFrameBusSubscriber::WaitForFrameAsync")
+		  , deferred_(Promise::Deferred::New(env))
+		  , memory_(memory)
+		  , seen_(seen)
+		  , timeout_(timeout)
+		  , published_(seen) {
+		}
+
+		Napi::Promise GetPromise() const {
+			return deferred_.Promise();
+		}
+
+	  protected:
+		void Execute() override {
+			published_ = RingNotifier::Wait(memory_->Data(), seen_, timeout_);
+		}
+
+		void OnOK() override {
+			deferred_.Resolve(Number::New(Env(), static_cast<uint32_t>(published_)));
+		}
+
+	  private:
+		Promise::Deferred deferred_;
+		std::shared_ptr<SharedMemory> memory_;
+		int32_t seen_;
+		uint32_t timeout_;
+		int32_t published_;
+	};
+
+	std::shared_ptr<SharedMemory> memory_;
+
+	void DestroyMe() {
+		memory_ = nullptr;
+	}
+
+	static void ReleaseMemory(Napi::Env, void*, std::shared_ptr<SharedMemory>* hint) {
+		delete hint;
+	}
+
+	/**
+	 * info[0] -> Name the RSFrameBus was created with
+	 */
+	Napi::Value Open(const CallbackInfo& info) {
+		this->DestroyMe();
+
+		std::string failure;
+		auto memory = SharedMemory::Open(info[0].ToString().Utf8Value(), &failure);
+		if (!memory) {
+			Error::New(info.Env(), failure).ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+		auto data = memory->Data();
+		if (memory->Length() < FrameRing::kRingHeaderBytes
+			|| FrameRing::Word(data, FrameRing::kRingMagic).load(std::memory_order_acquire) != FrameRing::kMagic) {
+			RangeError::New(info.Env(), "Not a frame ring").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+		// Readers index slots from the header words, which must not reach past the mapping.
+		uint32_t slot_count = FrameRing::Word(data, FrameRing::kRingSlotCount).load(std::memory_order_relaxed);
+		uint32_t slot_bytes = FrameRing::Word(data, FrameRing::kRingSlotBytes).load(std::memory_order_relaxed);
+		if (slot_count < 2 || !slot_bytes || memory->Length() < FrameRing::ByteLength(slot_count, slot_bytes)) {
+			RangeError::New(info.Env(), "Frame ring is larger than its shared memory").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		this->memory_ = memory;
+		return info.This();
+	}
+
+	// Buffers keep the mapping alive, even after destroy(), until they are collected.
+	Napi::Value GetBuffer(const CallbackInfo& info) {
+		if (!this->memory_) return info.Env().Undefined();
+
+		auto hint = new std::shared_ptr<SharedMemory>(this->memory_);
+		return ArrayBuffer::New(info.Env(), this->memory_->Data(), this->memory_->Length(), ReleaseMemory, hint);
+	}
+
+	/**
+	 * info[0] -> The published count last seen
+	 * info[1] -> Timeout in milliseconds, default to 5000
+	 *
+	 * Blocks the event loop until the published count moves on, and returns it; prefer waitForFrameAsync.
+	 */
+	Napi::Value WaitForFrame(const CallbackInfo& info) {
+		if (!this->memory_) return info.Env().Undefined();
+
+		auto seen	 = static_cast<int32_t>(info[0].ToNumber().Uint32Value());
+		auto timeout = info[1].IsNumber() ? info[1].ToNumber().Uint32Value() : 5000;
+		auto current = RingNotifier::Wait(this->memory_->Data(), seen, timeout);
+		return Number::New(info.Env(), static_cast<uint32_t>(current));
+	}
+
+	Napi::Value WaitForFrameAsync(const CallbackInfo& info) {
+		if (!this->memory_) {
+			auto deferred = Promise::Deferred::New(info.Env());
+			deferred.Reject(Error::New(info.Env(), "Frame bus is not open").Value());
+			return deferred.Promise();
+		}
+
+		auto seen	 = static_cast<int32_t>(info[0].ToNumber().Uint32Value());
+		auto timeout = info[1].IsNumber() ? info[1].ToNumber().Uint32Value() : 5000;
+		auto worker	 = new WaitForFrameWorker(info.Env(), this->memory_, seen, timeout);
+		worker->Queue();
+		return worker->GetPromise();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+};
+
+#endif
@@ -1,88 +1,63 @@
 #ifndef FRAME_CALLBACKS_H
 #define FRAME_CALLBACKS_H
 
-#include "napi-thread-safe-callback.hpp"
-#include <iostream>
+#include "bounded_frame_queue.cc"
+#include "js_thread_signal.cc"
+#include "utils.cc"
 #include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
 
-// class RSSensor;
-// class FrameCallbackInfo : public MainThreadCallbackInfo {
-//   public:
-// 	FrameCallbackInfo(rs2_frame* frame, void* data)
-// 	  : frame_(frame)
-// 	  , sensor_(static_cast<RSSensor*>(data)) {
-// 	}
-// 	virtual ~FrameCallbackInfo() {
-// 		if (!consumed_) Release();
-// 	}
-// 	virtual void Run() {
-// 	}
-// 	virtual void Release() {
-// 		if (frame_) {
-// 			rs2_release_frame(frame_);
-// 			frame_ = nullptr;
-// 		}
-// 	}
-
-//   private:
-// 	rs2_frame* frame_;
-// 	RSSensor* sensor_;
-// };
-
-class FrameCallbackForProc : public rs2_frame_callback {
-  private:
-	std::shared_ptr<ThreadSafeCallback> fn_;
-	void* callback_data_;
-
+class FrameCallbackForFrameQueue : public rs2_frame_callback {
   public:
-	explicit FrameCallbackForProc(std::shared_ptr<ThreadSafeCallback> fn, void* data)
-	  : fn_(fn)
-	  , callback_data_(data) {
-		std::cerr << "Constructing FrameCallbackForProc" << std::endl;
+	explicit FrameCallbackForFrameQueue(rs2_frame_queue* queue)
+	  : frame_queue_(queue) {
 	}
 	void on_frame(rs2_frame* frame) override {
-		this->fn_->call([frame](Napi::Env env, std::vector<napi_value>& args) {
-			std::cerr << __FILE__ << ":" << __LINE__ << "\tFrameCallbackForProc::on_frame" << std::endl;
-			throw "Not implemented!";
-		});
+		if (frame && frame_queue_) rs2_enqueue_frame(frame, frame_queue_);
 	}
 	void release() override {
 		delete this;
 	}
+	rs2_frame_queue* frame_queue_;
 };
 
-class FrameCallbackForFrameQueue : public rs2_frame_callback {
+class FrameCallbackForBoundedQueue : public rs2_frame_callback {
   public:
-	explicit FrameCallbackForFrameQueue(rs2_frame_queue* queue)
-	  : frame_queue_(queue) {
+	FrameCallbackForBoundedQueue(std::shared_ptr<BoundedFrameQueue> queue, std::shared_ptr<JSThreadSignal> signal)
+	  : queue_(queue)
+	  , signal_(signal) {
 	}
 	void on_frame(rs2_frame* frame) override {
-		if (frame && frame_queue_) rs2_enqueue_frame(frame, frame_queue_);
+		if (queue_->Push(frame) && signal_) signal_->Signal();
 	}
 	void release() override {
 		delete this;
 	}
-	rs2_frame_queue* frame_queue_;
+	std::shared_ptr<BoundedFrameQueue> queue_;
+	std::shared_ptr<JSThreadSignal> signal_;
 };
 
 class FrameCallbackForProcessingBlock : public rs2_frame_callback {
   public:
+	// Must be created on the JS thread of the env that owns the block.
 	explicit FrameCallbackForProcessingBlock(rs2_processing_block* block_ptr)
 	  : block_(block_ptr)
-	  , error_(nullptr) {
-		std::cerr << "Constructing FrameCallbackForProcessingBlock" << std::endl;
+	  , error_(nullptr)
+	  , errors_to_(ErrorUtil::Current()) {
 	}
 	virtual ~FrameCallbackForProcessingBlock() {
-		if (error_) rs2_free_error(error_);
 	}
 	void on_frame(rs2_frame* frame) override {
-		rs2_process_frame(block_, frame, &error_);
+		// Runs on a librealsense thread, failures are forwarded to the JS error callback of the owning env.
+		ErrorUtil::ForwardScope scope(errors_to_);
+		CallNativeFunc(rs2_process_frame, &error_, block_, frame, &error_);
 	}
 	void release() override {
 		delete this;
 	}
 	rs2_processing_block* block_;
 	rs2_error* error_;
+	std::shared_ptr<ErrorUtil> errors_to_;
 };
 
 #endif
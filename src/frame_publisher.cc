@@ -0,0 +1,345 @@
+#ifndef FRAME_PUBLISHER_H
+#define FRAME_PUBLISHER_H
+
+#include "addon_data.cc"
+#include "utils.cc"
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <mutex>
+#include <napi.h>
+#include <vector>
+
+using namespace Napi;
+
+/**
+ * A ring of frame slots in memory that cannot be detached under the writer, a SharedArrayBuffer that
+ * worker_threads map too, written straight from the librealsense callback thread.
+ *
+ * The buffer starts with a ring header, followed by the slots, each a slot header and the frame data. All
+ * header fields are little-endian int32 words, so JS reads them through an Int32Array with Atomics. A slot
+ * is guarded by a seqlock: its sequence word is odd while the slot is being written, and readers retry when
+ * it is odd or changed while they copied. The layout is mirrored by RSFrameRingHeader, RSFrameSlotHeader and
+ * FrameRingReader on the JS side. The same ring backs the shared memory of an RSFrameBus.
+ */
+class FrameRing {
+  public:
+	enum RingHeader {
+		kRingMagic = 0,
+		kRingSlotCount,
+		kRingSlotBytes,
+		// Index of the slot written last, -1 until the first frame
+		kRingLatest,
+		kRingPublished,
+		// Frames larger than a slot, which are left out
+		kRingSkipped,
+		// Readers blocked until the published count changes, for rings shared between processes
+		kRingWaiters,
+		kRingHeaderWords = 16
+	};
+
+	enum SlotHeader {
+		kSlotSequence = 0,
+		kSlotStream,
+		kSlotStreamIndex,
+		kSlotFormat,
+		kSlotWidth,
+		kSlotHeight,
+		kSlotStride,
+		kSlotBitsPerPixel,
+		kSlotDataSize,
+		kSlotFrameNumberLow,
+		kSlotFrameNumberHigh,
+		kSlotTimestampDomain,
+		// A float64 over two words, 8 byte aligned
+		kSlotTimestamp,
+		kSlotHeaderWords = 16
+	};
+
+	static const int32_t kMagic			 = 0x52534652;
+	static const size_t kRingHeaderBytes = kRingHeaderWords * sizeof(int32_t);
+	static const size_t kSlotHeaderBytes = kSlotHeaderWords * sizeof(int32_t);
+
+	static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "header words are used as atomics in place");
+
+	// Slot sizes are rounded up to keep every slot header 8 byte aligned.
+	static size_t ByteLength(uint32_t slot_count, uint32_t slot_bytes) {
+		return kRingHeaderBytes + slot_count * (kSlotHeaderBytes + Align(slot_bytes));
+	}
+
+	static size_t Align(size_t bytes) {
+		return (bytes + 7) & ~static_cast<size_t>(7);
+	}
+
+	/**
+	 * An empty list of streams publishes every stream. The ring keeps memory_owner, if any, alive for as long
+	 * as a callback may still hold the ring, and calls on_publish after every frame, with the lock held.
+	 */
+	FrameRing(
+	  uint8_t* memory,
+	  uint32_t slot_count,
+	  uint32_t slot_bytes,
+	  const std::vector<rs2_stream>& streams,
+	  std::shared_ptr<void> memory_owner = nullptr,
+	  std::function<void()> on_publish	 = nullptr)
+	  : memory_(memory)
+	  , slot_count_(slot_count)
+	  , slot_bytes_(Align(slot_bytes))
+	  , streams_(streams)
+	  , memory_owner_(memory_owner)
+	  , on_publish_(on_publish)
+	  , closed_(false) {
+		Word(memory_, kRingSlotCount).store(slot_count_, std::memory_order_relaxed);
+		Word(memory_, kRingSlotBytes).store(static_cast<int32_t>(slot_bytes_), std::memory_order_relaxed);
+		Word(memory_, kRingLatest).store(-1, std::memory_order_relaxed);
+		Word(memory_, kRingPublished).store(0, std::memory_order_relaxed);
+		Word(memory_, kRingSkipped).store(0, std::memory_order_relaxed);
+		Word(memory_, kRingWaiters).store(0, std::memory_order_relaxed);
+		for (uint32_t i = 0; i < slot_count_; i++)
+			Word(Slot(i), kSlotSequence).store(0, std::memory_order_relaxed);
+		// Last, so a reader that sees the magic sees a complete header.
+		Word(memory_, kRingMagic).store(kMagic, std::memory_order_release);
+	}
+
+	static std::atomic<int32_t>& Word(uint8_t* base, int index) {
+		return reinterpret_cast<std::atomic<int32_t>*>(base)[index];
+	}
+
+	// Called on the librealsense thread for every frame, framesets are unpacked.
+	void PushFrame(rs2_frame* frame) {
+		rs2_error* error = nullptr;
+		if (rs2_is_frame_extendable_to(frame, RS2_EXTENSION_COMPOSITE_FRAME, &error) && !error) {
+			auto count = rs2_embedded_frames_count(frame, &error);
+			for (int i = 0; i < count && !error; i++) {
+				auto embedded = rs2_extract_frame(frame, i, &error);
+				if (!embedded) continue;
+
+				PushFrame(embedded);
+				rs2_release_frame(embedded);
+			}
+		}
+		else if (!error) {
+			Publish(frame, &error);
+		}
+
+		if (error) rs2_free_error(error);
+	}
+
+	// Once closed, nothing touches the memory again, so JS may let go of it.
+	void Close() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		closed_ = true;
+	}
+
+  private:
+	uint8_t* Slot(uint32_t index) const {
+		return memory_ + kRingHeaderBytes + index * (kSlotHeaderBytes + slot_bytes_);
+	}
+
+	bool Selected(rs2_stream stream) const {
+		if (streams_.empty()) return true;
+
+		for (auto selected : streams_) {
+			if (selected == stream) return true;
+		}
+		return false;
+	}
+
+	void Publish(rs2_frame* frame, rs2_error** error) {
+		auto profile	  = rs2_get_frame_stream_profile(frame, error);
+		rs2_stream stream = RS2_STREAM_ANY;
+		rs2_format format = RS2_FORMAT_ANY;
+		int index = 0, unique_id = 0, fps = 0;
+		if (!*error) rs2_get_stream_profile_data(profile, &stream, &format, &index, &unique_id, &fps, error);
+		if (*error || !Selected(stream)) return;
+
+		auto data	   = static_cast<const uint8_t*>(rs2_get_frame_data(frame, error));
+		auto data_size = *error ? 0 : rs2_get_frame_data_size(frame, error);
+		if (*error || !data || data_size <= 0) return;
+
+		int32_t width = 0, height = 0, stride = 0, bpp = 0;
+		if (rs2_is_frame_extendable_to(frame, RS2_EXTENSION_VIDEO_FRAME, error) && !*error) {
+			width  = rs2_get_frame_width(frame, error);
+			height = *error ? 0 : rs2_get_frame_height(frame, error);
+			stride = *error ? 0 : rs2_get_frame_stride_in_bytes(frame, error);
+			bpp	   = *error ? 0 : rs2_get_frame_bits_per_pixel(frame, error);
+		}
+		auto frame_number = *error ? 0 : rs2_get_frame_number(frame, error);
+		auto timestamp	  = *error ? 0 : rs2_get_frame_timestamp(frame, error);
+		auto domain		  = *error ? RS2_TIMESTAMP_DOMAIN_COUNT : rs2_get_frame_timestamp_domain(frame, error);
+		if (*error) return;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (closed_) return;
+		if (static_cast<size_t>(data_size) > slot_bytes_) {
+			Word(memory_, kRingSkipped).fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		// Only this thread writes, under the lock, so the next slot is the one after the latest.
+		auto latest		  = Word(memory_, kRingLatest).load(std::memory_order_relaxed);
+		uint32_t next	  = latest < 0 ? 0 : (static_cast<uint32_t>(latest) + 1) % slot_count_;
+		uint8_t* slot	  = Slot(next);
+		auto& sequence	  = Word(slot, kSlotSequence);
+		int32_t begin_seq = sequence.load(std::memory_order_relaxed) + 1;
+
+		sequence.store(begin_seq, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		auto words = reinterpret_cast<int32_t*>(slot);
+
+		words[kSlotStream]			= stream;
+		words[kSlotStreamIndex]		= index;
+		words[kSlotFormat]			= format;
+		words[kSlotWidth]			= width;
+		words[kSlotHeight]			= height;
+		words[kSlotStride]			= stride;
+		words[kSlotBitsPerPixel]	= bpp;
+		words[kSlotDataSize]		= data_size;
+		words[kSlotFrameNumberLow]	= static_cast<int32_t>(frame_number & 0xffffffff);
+		words[kSlotFrameNumberHigh] = static_cast<int32_t>(frame_number >> 32);
+		words[kSlotTimestampDomain] = domain;
+		memcpy(slot + kSlotTimestamp * sizeof(int32_t), &timestamp, sizeof(double));
+		memcpy(slot + kSlotHeaderBytes, data, data_size);
+
+		sequence.store(begin_seq + 1, std::memory_order_release);
+		Word(memory_, kRingLatest).store(static_cast<int32_t>(next), std::memory_order_release);
+		// Sequentially consistent, so a reader registering as a waiter either sees the new count or gets woken.
+		Word(memory_, kRingPublished).fetch_add(1, std::memory_order_seq_cst);
+		if (on_publish_) on_publish_();
+	}
+
+	uint8_t* memory_;
+	const uint32_t slot_count_;
+	const size_t slot_bytes_;
+	const std::vector<rs2_stream> streams_;
+	std::shared_ptr<void> memory_owner_;
+	std::function<void()> on_publish_;
+	bool closed_;
+	std::mutex mutex_;
+};
+
+class FrameCallbackForFrameRing : public rs2_frame_callback {
+  public:
+	explicit FrameCallbackForFrameRing(std::shared_ptr<FrameRing> ring)
+	  : ring_(ring) {
+	}
+	void on_frame(rs2_frame* frame) override {
+		ring_->PushFrame(frame);
+		rs2_release_frame(frame);
+	}
+	void release() override {
+		delete this;
+	}
+	std::shared_ptr<FrameRing> ring_;
+};
+
+class RSFramePublisher : public ObjectWrap<RSFramePublisher> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSFramePublisher",
+		  {
+			StaticMethod("byteLength", &RSFramePublisher::ByteLength),
+			InstanceMethod("create", &RSFramePublisher::Create),
+			InstanceMethod("destroy", &RSFramePublisher::Destroy),
+		  });
+
+		AddonData::SetConstructor<RSFramePublisher>(env, func);
+		exports.Set("RSFramePublisher", func);
+
+		return exports;
+	}
+
+	RSFramePublisher(const CallbackInfo& info)
+	  : ObjectWrap<RSFramePublisher>(info) {
+	}
+
+	~RSFramePublisher() {
+		DestroyMe();
+	}
+
+  private:
+	friend class RSPipeline;
+	friend class RSSensor;
+
+	std::shared_ptr<FrameRing> ring_;
+	// Keeps the ring memory alive for as long as librealsense may write to it.
+	ObjectReference buffer_;
+
+	void DestroyMe() {
+		if (ring_) ring_->Close();
+		ring_ = nullptr;
+		buffer_.Reset();
+	}
+
+	/**
+	 * info[0] -> Slot count
+	 * info[1] -> Largest frame data size in bytes a slot holds
+	 */
+	static Napi::Value ByteLength(const CallbackInfo& info) {
+		auto slot_count = info[0].ToNumber().Uint32Value();
+		auto slot_bytes = info[1].ToNumber().Uint32Value();
+
+		return Number::New(info.Env(), static_cast<double>(FrameRing::ByteLength(slot_count, slot_bytes)));
+	}
+
+	/**
+	 * info[0] -> A typed array over a SharedArrayBuffer holding the ring, e.g. new Int32Array(sharedArrayBuffer),
+	 *            at least byteLength(slotCount, slotBytes) bytes long. Other buffers are refused, as they can be
+	 *            detached by a transfer while librealsense still writes into them.
+	 * info[1] -> Slot count, at least 2 so a reader never races the writer on a single slot
+	 * info[2] -> Largest frame data size in bytes a slot holds; larger frames are counted and left out
+	 * info[3] -> Optional array of RSStreamType to publish, all streams when missing or empty
+	 */
+	Napi::Value Create(const CallbackInfo& info) {
+		if (!info[0].IsTypedArray()) {
+			TypeError::New(info.Env(), "Expected a typed array over the ring memory").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		auto array		= info[0].As<TypedArray>();
+		auto slot_count = info[1].IsNumber() ? info[1].ToNumber().Uint32Value() : 0;
+		auto slot_bytes = info[2].IsNumber() ? info[2].ToNumber().Uint32Value() : 0;
+
+		// Asked from the typed array itself, as N-API has no SharedArrayBuffer wrapper to read it from.
+		void* memory			= nullptr;
+		napi_value array_buffer = nullptr;
+		napi_get_typedarray_info(info.Env(), array, nullptr, nullptr, &memory, &array_buffer, nullptr);
+		auto shared_constructor = info.Env().Global().Get("SharedArrayBuffer");
+		if (
+		  !array_buffer || !shared_constructor.IsFunction()
+		  || !Napi::Value(info.Env(), array_buffer).ToObject().InstanceOf(shared_constructor.As<Function>())) {
+			TypeError::New(info.Env(), "Expected a typed array over a SharedArrayBuffer").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+		if (
+		  !memory || slot_count < 2 || !slot_bytes || reinterpret_cast<uintptr_t>(memory) % 8
+		  || array.ByteLength() < FrameRing::ByteLength(slot_count, slot_bytes)) {
+			RangeError::New(info.Env(), "The ring memory does not fit the slots").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		std::vector<rs2_stream> streams;
+		if (info[3].IsArray()) {
+			auto list = info[3].As<Array>();
+			for (uint32_t i = 0; i < list.Length(); i++)
+				streams.push_back(static_cast<rs2_stream>(list.Get(i).ToNumber().Int32Value()));
+		}
+
+		this->DestroyMe();
+		this->ring_ = std::make_shared<FrameRing>(static_cast<uint8_t*>(memory), slot_count, slot_bytes, streams);
+		this->buffer_ = Napi::Persistent(Object(array));
+		return info.This();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+};
+
+#endif
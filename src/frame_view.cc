@@ -0,0 +1,93 @@
+#ifndef FRAME_VIEW_H
+#define FRAME_VIEW_H
+
+#include "addon_data.cc"
+#include "utils.cc"
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <napi.h>
+#include <unordered_map>
+
+using namespace Napi;
+
+/**
+ * Zero-copy ArrayBuffers over librealsense frame memory.
+ *
+ * Every buffer takes its own reference on the frame, which is given back by the buffer's finalizer, so a
+ * view stays valid for as long as JS holds on to it, no matter what happens to the RSFrame it came from.
+ * The frame size is reported to the GC through the external memory counter.
+ * Each env keeps its own registry of live views, which every view holds on to until it is finalized.
+ */
+class FrameView {
+  public:
+	static ArrayBuffer NewBuffer(Napi::Env env, rs2_frame* frame, const void* data, size_t length) {
+		// V8 refuses two live external buffers over the same memory, so reuse the one that already exists.
+		auto registry = AddonData::Shared<Registry>(env);
+		auto it		  = registry->views.find(data);
+		if (it != registry->views.end()) {
+			// A live buffer at least as long serves the request too, as typed arrays only view its start.
+			auto existing = it->second->buffer_.Value();
+			if (!existing.IsEmpty() && existing.As<ArrayBuffer>().ByteLength() >= length)
+				return existing.As<ArrayBuffer>();
+
+			// Either the old buffer was collected but not finalized yet, or it is live but shorter, e.g. a
+			// point cloud's vertices under getData(). Both still own the memory; copy instead.
+			auto copy = ArrayBuffer::New(env, length);
+			memcpy(copy.Data(), data, length);
+			return copy;
+		}
+
+		rs2_error* error = nullptr;
+		CallNativeFunc(rs2_frame_add_ref, &error, frame, &error);
+		if (error) return ArrayBuffer::New(env, 0);
+
+		auto view	 = new FrameView(frame, data, length, registry);
+		auto buffer	 = ArrayBuffer::New(env, const_cast<void*>(data), length, Finalize, view);
+		view->buffer_ = Napi::Weak(buffer);
+		registry->views.emplace(data, view);
+		MemoryManagement::AdjustExternalMemory(env, static_cast<int64_t>(length));
+
+		return buffer;
+	}
+
+	template<typename T>
+	static Value NewTypedArray(Napi::Env env, rs2_frame* frame, const void* data, size_t element_count) {
+		if (!frame || !data || !element_count) return env.Undefined();
+
+		auto buffer = NewBuffer(env, frame, data, element_count * sizeof(T));
+		if (buffer.ByteLength() < element_count * sizeof(T)) return env.Undefined();
+
+		return TypedArrayOf<T>::New(env, element_count, buffer, 0);
+	}
+
+  private:
+	struct Registry {
+		std::unordered_map<const void*, FrameView*> views;
+	};
+
+	FrameView(rs2_frame* frame, const void* data, size_t length, std::shared_ptr<Registry> registry)
+	  : frame_(frame)
+	  , data_(data)
+	  , length_(length)
+	  , registry_(registry) {
+	}
+
+	// May run while the env is torn down, so only the registry the view holds is touched.
+	static void Finalize(Napi::Env env, void* data, FrameView* view) {
+		auto& views = view->registry_->views;
+		auto it		= views.find(view->data_);
+		if (it != views.end() && it->second == view) views.erase(it);
+
+		MemoryManagement::AdjustExternalMemory(env, -static_cast<int64_t>(view->length_));
+		rs2_release_frame(view->frame_);
+		delete view;
+	}
+
+	rs2_frame* frame_;
+	const void* data_;
+	size_t length_;
+	std::shared_ptr<Registry> registry_;
+	ObjectReference buffer_;
+};
+
+#endif
@@ -1,127 +1,169 @@
 #ifndef FRAMEQUEUE_H
 #define FRAMEQUEUE_H
 
-class RSFrameQueue : public Nan::ObjectWrap {
-public:
-  static void Init(v8::Local<v8::Object> exports) {
-    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
-    tpl->SetClassName(Nan::New("RSFrameQueue").ToLocalChecked());
-    tpl->InstanceTemplate()->SetInternalFieldCount(1);
-
-    Nan::SetPrototypeMethod(tpl, "create", Create);
-    Nan::SetPrototypeMethod(tpl, "destroy", Destroy);
-    Nan::SetPrototypeMethod(tpl, "waitForFrame", WaitForFrame);
-    Nan::SetPrototypeMethod(tpl, "pollForFrame", PollForFrame);
-    Nan::SetPrototypeMethod(tpl, "enqueueFrame", EnqueueFrame);
-
-    constructor_.Reset(tpl->GetFunction());
-    exports->Set(Nan::New("RSFrameQueue").ToLocalChecked(), tpl->GetFunction());
-  }
-
-  static v8::Local<v8::Object> NewInstance() {
-    Nan::EscapableHandleScope scope;
-
-    v8::Local<v8::Function> cons = Nan::New<v8::Function>(constructor_);
-    v8::Local<v8::Context> context =
-        v8::Isolate::GetCurrent()->GetCurrentContext();
-
-    v8::Local<v8::Object> instance =
-        cons->NewInstance(context, 0, nullptr).ToLocalChecked();
-
-    return scope.Escape(instance);
-  }
-
-private:
-  RSFrameQueue() : frame_queue_(nullptr), error_(nullptr) {}
-
-  ~RSFrameQueue() { DestroyMe(); }
-
-  void DestroyMe() {
-    if (error_)
-      rs2_free_error(error_);
-    error_ = nullptr;
-    if (frame_queue_)
-      rs2_delete_frame_queue(frame_queue_);
-    frame_queue_ = nullptr;
-  }
-
-  static void New(const Nan::FunctionCallbackInfo<v8::Value> &info) {
-    if (info.IsConstructCall()) {
-      RSFrameQueue *obj = new RSFrameQueue();
-      obj->Wrap(info.This());
-      info.GetReturnValue().Set(info.This());
-    }
-  }
-
-  static NAN_METHOD(WaitForFrame) {
-    info.GetReturnValue().Set(Nan::Undefined());
-    int32_t timeout = info[0]->IntegerValue(); // in ms
-    auto me = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info.Holder());
-    if (!me)
-      return;
-
-    auto frame =
-        GetNativeResult<rs2_frame *>(rs2_wait_for_frame, &me->error_,
-                                     me->frame_queue_, timeout, &me->error_);
-    if (!frame)
-      return;
-
-    info.GetReturnValue().Set(RSFrame::NewInstance(frame));
-  }
-
-  static NAN_METHOD(Create) {
-    info.GetReturnValue().Set(Nan::Undefined());
-    int32_t capacity = info[0]->IntegerValue();
-    auto me = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info.Holder());
-    if (!me)
-      return;
-
-    me->frame_queue_ = GetNativeResult<rs2_frame_queue *>(
-        rs2_create_frame_queue, &me->error_, capacity, &me->error_);
-  }
-
-  static NAN_METHOD(Destroy) {
-    auto me = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info.Holder());
-    if (me) {
-      me->DestroyMe();
-    }
-    info.GetReturnValue().Set(Nan::Undefined());
-  }
-
-  static NAN_METHOD(PollForFrame) {
-    info.GetReturnValue().Set(Nan::Undefined());
-    auto me = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info.Holder());
-    if (!me)
-      return;
-
-    rs2_frame *frame = nullptr;
-    auto res = GetNativeResult<int>(rs2_poll_for_frame, &me->error_,
-                                    me->frame_queue_, &frame, &me->error_);
-    if (!res)
-      return;
-
-    info.GetReturnValue().Set(RSFrame::NewInstance(frame));
-  }
-
-  static NAN_METHOD(EnqueueFrame) {
-    auto me = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info.Holder());
-    auto frame = Nan::ObjectWrap::Unwrap<RSFrame>(info[0]->ToObject());
-
-    if (me && frame) {
-      rs2_enqueue_frame(frame->frame_, me->frame_queue_);
-      frame->frame_ = nullptr;
-    }
-    info.GetReturnValue().Set(Nan::Undefined());
-  }
-
-private:
-  static Nan::Persistent<v8::Function> constructor_;
-  rs2_frame_queue *frame_queue_;
-  rs2_error *error_;
-  friend class RSDevice;
+#include "addon_data.cc"
+#include "bounded_frame_queue.cc"
+#include "dicts.cc"
+#include "frame.cc"
+#include "frameset.cc"
+#include "utils.cc"
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <napi.h>
+
+using namespace Napi;
+
+/**
+ * A frame queue that decouples producers (sensors, or frames enqueued from JS) from a JS consumer.
+ * When full, the oldest frame is dropped, so a burst never blocks the producer; the occupancy counters
+ * from getStats() tell how much capacity a burst really needs.
+ */
+class RSFrameQueue : public ObjectWrap<RSFrameQueue> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSFrameQueue",
+		  {
+			InstanceMethod("create", &RSFrameQueue::Create),
+			InstanceMethod("destroy", &RSFrameQueue::Destroy),
+			InstanceMethod("enqueueFrame", &RSFrameQueue::EnqueueFrame),
+			InstanceMethod("getStats", &RSFrameQueue::GetStats),
+			InstanceMethod("poll", &RSFrameQueue::Poll),
+			InstanceMethod("waitForFrame", &RSFrameQueue::WaitForFrame),
+			InstanceMethod("waitForFrameAsync", &RSFrameQueue::WaitForFrameAsync),
+		  });
+
+		AddonData::SetConstructor<RSFrameQueue>(env, func);
+		exports.Set("RSFrameQueue", func);
+
+		return exports;
+	}
+
+	static Object NewInstance(Napi::Env env) {
+		EscapableHandleScope scope(env);
+		Object instance = AddonData::Constructor<RSFrameQueue>(env).New({});
+
+		return scope.Escape(napi_value(instance)).ToObject();
+	}
+
+	RSFrameQueue(const CallbackInfo& info)
+	  : ObjectWrap<RSFrameQueue>(info) {
+	}
+
+	~RSFrameQueue() {
+		DestroyMe();
+	}
+
+  private:
+	friend class RSSensor;
+
+	/**
+	 * Waits for a frame on the libuv thread pool and settles the promise returned by waitForFrameAsync.
+	 * The worker shares ownership of the queue, and destroy() closes it, which ends the wait early.
+	 */
+	class WaitForFrameWorker : public AsyncWorker {
+	  public:
+		WaitForFrameWorker(Napi::Env env, std::shared_ptr<BoundedFrameQueue> queue, uint32_t timeout)
+		  : AsyncWorker(env, "RSFrameQueue::WaitForFrameAsync")
+		  , deferred_(Promise::Deferred::New(env))
+		  , queue_(queue)
+		  , timeout_(timeout)
+		  , frame_(nullptr) {
+		}
+
+		Napi::Promise GetPromise() const {
+			return deferred_.Promise();
+		}
+
+	  protected:
+		void Execute() override {
+			queue_->Pop(&frame_, timeout_);
+		}
+
+		void OnOK() override {
+			deferred_.Resolve(frame_ ? NewFrameOrFrameSet(Env(), frame_) : Env().Undefined());
+		}
+
+	  private:
+		Promise::Deferred deferred_;
+		std::shared_ptr<BoundedFrameQueue> queue_;
+		uint32_t timeout_;
+		rs2_frame* frame_;
+	};
+
+	std::shared_ptr<BoundedFrameQueue> queue_;
+
+	void DestroyMe() {
+		if (queue_) {
+			queue_->Close();
+			queue_->Clear();
+		}
+		queue_ = nullptr;
+	}
+
+	/**
+	 * info[0] -> Capacity, default to 1
+	 * info[1] -> Keep frames, which detaches queued frames from the librealsense frame pool
+	 */
+	Napi::Value Create(const CallbackInfo& info) {
+		auto capacity	 = info[0].IsNumber() ? info[0].ToNumber().Uint32Value() : 1;
+		auto keep_frames = info[1].IsBoolean() ? info[1].ToBoolean().Value() : false;
+
+		this->DestroyMe();
+		this->queue_ = std::make_shared<BoundedFrameQueue>(BoundedFrameQueue::kDropOldest, capacity, keep_frames);
+		return info.This();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+
+	// The queue takes over the frame, which leaves the RSFrame empty.
+	Napi::Value EnqueueFrame(const CallbackInfo& info) {
+		auto frame = info[0].IsObject() ? ObjectWrap<RSFrame>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!this->queue_ || !frame || !frame->frame_) return Boolean::New(info.Env(), false);
+
+		auto queued = this->queue_->Push(frame->frame_);
+		frame->SetFrame(nullptr, 0);
+		return Boolean::New(info.Env(), queued);
+	}
+
+	Napi::Value GetStats(const CallbackInfo& info) {
+		if (!this->queue_) return info.Env().Undefined();
+
+		return RSFrameQueueStats(info.Env(), this->queue_->GetStats()).GetObject();
+	}
+
+	Napi::Value Poll(const CallbackInfo& info) {
+		rs2_frame* frame = nullptr;
+		if (!this->queue_ || !this->queue_->TryPop(&frame)) return info.Env().Undefined();
+
+		return NewFrameOrFrameSet(info.Env(), frame);
+	}
+
+	// Blocks the event loop; prefer waitForFrameAsync.
+	Napi::Value WaitForFrame(const CallbackInfo& info) {
+		auto timeout	 = info[0].IsNumber() ? info[0].ToNumber().Uint32Value() : 5000;
+		rs2_frame* frame = nullptr;
+		if (!this->queue_ || !this->queue_->Pop(&frame, timeout)) return info.Env().Undefined();
+
+		return NewFrameOrFrameSet(info.Env(), frame);
+	}
+
+	Napi::Value WaitForFrameAsync(const CallbackInfo& info) {
+		auto timeout = info[0].IsNumber() ? info[0].ToNumber().Uint32Value() : 5000;
+		if (!this->queue_) {
+			auto deferred = Promise::Deferred::New(info.Env());
+			deferred.Reject(Error::New(info.Env(), "Frame queue is not created").Value());
+			return deferred.Promise();
+		}
+
+		auto worker = new WaitForFrameWorker(info.Env(), this->queue_, timeout);
+		worker->Queue();
+		return worker->GetPromise();
+	}
 };
 
-Nan::Persistent<v8::Function> RSFrameQueue::constructor_;
-
-
 #endif
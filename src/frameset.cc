@@ -1,12 +1,15 @@
 #ifndef FRAMESET_H
 #define FRAMESET_H
 
+#include "addon_data.cc"
 #include "frame.cc"
 #include "stream_profile_extractor.cc"
 #include "utils.cc"
 #include <iostream>
 #include <librealsense2/hpp/rs_types.hpp>
 #include <napi.h>
+#include <utility>
+#include <vector>
 using namespace Napi;
 
 class RSFrameSet : public ObjectWrap<RSFrameSet> {
@@ -18,13 +21,13 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 		  {
 			InstanceMethod("destroy", &RSFrameSet::Destroy),
 			InstanceMethod("getFrame", &RSFrameSet::GetFrame),
+			InstanceMethod("getFrames", &RSFrameSet::GetFrames),
 			InstanceMethod("getSize", &RSFrameSet::GetSize),
 			InstanceMethod("indexToStream", &RSFrameSet::IndexToStream),
 			InstanceMethod("indexToStreamIndex", &RSFrameSet::IndexToStreamIndex),
 			InstanceMethod("replaceFrame", &RSFrameSet::ReplaceFrame),
 		  });
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSFrameSet>(env, func);
 		exports.Set("RSFrameSet", func);
 
 		return exports;
@@ -32,7 +35,7 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 
 	static Object NewInstance(Napi::Env env, rs2_frame* frame) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSFrameSet>(env).New({});
 		auto unwrapped	= ObjectWrap<RSFrameSet>::Unwrap(instance);
 		unwrapped->SetFrame(frame);
 
@@ -50,8 +53,9 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 
 	RSFrameSet(const CallbackInfo& info)
 	  : ObjectWrap<RSFrameSet>(info) {
-		error_	= nullptr;
-		frames_ = nullptr;
+		error_		 = nullptr;
+		frames_		 = nullptr;
+		frame_count_ = 0;
 	}
 
 	~RSFrameSet() {
@@ -59,12 +63,38 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 	}
 
   private:
-	static FunctionReference constructor;
+	// One entry per embedded frame, in frameset order, holding its own reference to the frame.
+	struct FrameSlot {
+		rs2_frame* frame;
+		rs2_stream stream;
+		int32_t index;
+		// RSFrame type bits, classified once when the frameset is set
+		uint32_t type;
+	};
 
 	rs2_frame* frames_;
 	uint32_t frame_count_;
+	std::vector<FrameSlot> slots_;
 	rs2_error* error_;
 
+	// The most specific kind of frame, checked in the same order as librealsense's frame::is<T>() chains.
+	static const char* FrameType(uint32_t type) {
+		static const std::pair<uint32_t, const char*> kTypes[] = {
+			{ RSFrame::kTypePose, "pose" },
+			{ RSFrame::kTypeMotion, "motion" },
+			{ RSFrame::kTypeDisparity, "disparity" },
+			{ RSFrame::kTypeDepth, "depth" },
+			{ RSFrame::kTypeVideo, "video" },
+			{ RSFrame::kTypePoints, "points" },
+		};
+		for (const auto& entry : kTypes) {
+			if (type & entry.first) return entry.second;
+		}
+
+		return "frame";
+	}
+
+	// Embedded frames and their stream profiles are read once here, lookups then only scan the slots.
 	void SetFrame(rs2_frame* frame) {
 		if (
 		  !frame
@@ -74,11 +104,46 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 
 		frames_		 = frame;
 		frame_count_ = GetNativeResult<int>(rs2_embedded_frames_count, &error_, frame, &error_);
+		slots_.assign(frame_count_, FrameSlot{ nullptr, RS2_STREAM_ANY, 0, 0 });
+
+		for (uint32_t i = 0; i < frame_count_; i++) {
+			auto& slot = slots_[i];
+			slot.frame = GetNativeResult<rs2_frame*>(rs2_extract_frame, &error_, frame, i, &error_);
+			if (!slot.frame) continue;
+
+			const rs2_stream_profile* profile = GetNativeResult<
+			  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &error_, slot.frame, &error_);
+			if (profile) {
+				StreamProfileExtractor extractor(profile);
+				slot.stream = extractor.stream_;
+				slot.index	= extractor.index_;
+			}
+			slot.type = RSFrame::ClassifyFrame(slot.frame);
+		}
+	}
+
+	// Same matching as before: RS2_STREAM_ANY picks the first frame, a stream index of 0 the first of that stream.
+	const FrameSlot* FindSlot(rs2_stream stream, int32_t stream_index) const {
+		if (stream == RS2_STREAM_ANY) return slots_.empty() || !slots_[0].frame ? nullptr : &slots_[0];
+
+		for (const auto& slot : slots_) {
+			if (slot.frame && slot.stream == stream && (!stream_index || stream_index == slot.index)) return &slot;
+		}
+		return nullptr;
+	}
+
+	const FrameSlot* SlotAt(int32_t index) const {
+		if (index < 0 || static_cast<uint32_t>(index) >= slots_.size() || !slots_[index].frame) return nullptr;
+
+		return &slots_[index];
 	}
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
+		for (auto& slot : slots_) {
+			if (slot.frame) rs2_release_frame(slot.frame);
+		}
+		slots_.clear();
 		if (frames_) rs2_release_frame(frames_);
 		frames_ = nullptr;
 	}
@@ -96,32 +161,39 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 
 		rs2_stream stream = static_cast<rs2_stream>(info[0].ToNumber().Int32Value());
 		auto stream_index = info[1].ToNumber().Int32Value();
-		// if RS2_STREAM_ANY is used, we return the first frame.
-		if (stream == RS2_STREAM_ANY && this->frame_count_) {
-			rs2_frame* frame
-			  = GetNativeResult<rs2_frame*>(rs2_extract_frame, &this->error_, this->frames_, 0, &this->error_);
-			if (!frame) return info.Env().Undefined();
+		auto slot		  = this->FindSlot(stream, stream_index);
+		if (!slot) return info.Env().Undefined();
 
-			return RSFrame::NewInstance(info.Env(), frame);
-		}
+		// The slot keeps its own reference, the new RSFrame takes another one.
+		CallNativeFunc(rs2_frame_add_ref, &this->error_, slot->frame, &this->error_);
+		if (this->error_) return info.Env().Undefined();
 
-		for (uint32_t i = 0; i < this->frame_count_; i++) {
-			rs2_frame* frame
-			  = GetNativeResult<rs2_frame*>(rs2_extract_frame, &this->error_, this->frames_, i, &this->error_);
-			if (!frame) continue;
+		return RSFrame::NewInstance(info.Env(), slot->frame, slot->type);
+	}
 
-			const rs2_stream_profile* profile = GetNativeResult<
-			  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &this->error_, frame, &this->error_);
-			if (profile) {
-				StreamProfileExtractor extrator(profile);
-				if (
-				  extrator.stream_ == stream && (!stream_index || (stream_index && stream_index == extrator.index_))) {
-					return RSFrame::NewInstance(info.Env(), frame);
-				}
-			}
-			rs2_release_frame(frame);
+	/**
+	 * Returns every embedded frame at once, as { frame, stream, streamIndex, type } in frameset order, where
+	 * type is one of "pose", "motion", "disparity", "depth", "video", "points" or "frame".
+	 */
+	Napi::Value GetFrames(const CallbackInfo& info) {
+		auto frames = Array::New(info.Env());
+		if (!this->frames_) return frames;
+
+		uint32_t count = 0;
+		for (const auto& slot : this->slots_) {
+			if (!slot.frame) continue;
+
+			CallNativeFunc(rs2_frame_add_ref, &this->error_, slot.frame, &this->error_);
+			if (this->error_) break;
+
+			auto entry = Object::New(info.Env());
+			entry.Set("frame", RSFrame::NewInstance(info.Env(), slot.frame, slot.type));
+			entry.Set("stream", Number::New(info.Env(), slot.stream));
+			entry.Set("streamIndex", Number::New(info.Env(), slot.index));
+			entry.Set("type", String::New(info.Env(), FrameType(slot.type)));
+			frames.Set(count++, entry);
 		}
-		return info.Env().Undefined();
+		return frames;
 	}
 
 	Napi::Value GetSize(const CallbackInfo& info) {
@@ -132,56 +204,19 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 	Napi::Value IndexToStream(const CallbackInfo& info) {
 		if (!this->frames_) return info.Env().Undefined();
 
-		int32_t index = info[0].ToNumber().Int32Value();
-		rs2_frame* frame
-		  = GetNativeResult<rs2_frame*>(rs2_extract_frame, &this->error_, this->frames_, index, &this->error_);
-		if (!frame) return info.Env().Undefined();
-
-		const rs2_stream_profile* profile = GetNativeResult<
-		  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &this->error_, frame, &this->error_);
-		if (!profile) {
-			rs2_release_frame(frame);
-			return info.Env().Undefined();
-		}
-
-		rs2_stream stream = RS2_STREAM_ANY;
-		rs2_format format = RS2_FORMAT_ANY;
-		int32_t fps		  = 0;
-		int32_t idx		  = 0;
-		int32_t unique_id = 0;
-		CallNativeFunc(
-		  rs2_get_stream_profile_data, &this->error_, profile, &stream, &format, &idx, &unique_id, &fps, &this->error_);
-		rs2_release_frame(frame);
-		if (this->error_) return info.Env().Undefined();
+		auto slot = this->SlotAt(info[0].ToNumber().Int32Value());
+		if (!slot) return info.Env().Undefined();
 
-		return Number::New(info.Env(), stream);
+		return Number::New(info.Env(), slot->stream);
 	}
 
 	Napi::Value IndexToStreamIndex(const CallbackInfo& info) {
 		if (!this->frames_) return info.Env().Undefined();
 
-		int32_t index = info[0].ToNumber().Int32Value();
-		rs2_frame* frame
-		  = GetNativeResult<rs2_frame*>(rs2_extract_frame, &this->error_, this->frames_, index, &this->error_);
-		if (!frame) return info.Env().Undefined();
+		auto slot = this->SlotAt(info[0].ToNumber().Int32Value());
+		if (!slot) return info.Env().Undefined();
 
-		const rs2_stream_profile* profile = GetNativeResult<
-		  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &this->error_, frame, &this->error_);
-		if (!profile) {
-			rs2_release_frame(frame);
-			return info.Env().Undefined();
-		}
-		rs2_stream stream = RS2_STREAM_ANY;
-		rs2_format format = RS2_FORMAT_ANY;
-		int32_t fps		  = 0;
-		int32_t idx		  = 0;
-		int32_t unique_id = 0;
-		CallNativeFunc(
-		  rs2_get_stream_profile_data, &this->error_, profile, &stream, &format, &idx, &unique_id, &fps, &this->error_);
-		rs2_release_frame(frame);
-		if (this->error_) return info.Env().Undefined();
-
-		return Number::New(info.Env(), idx);
+		return Number::New(info.Env(), slot->index);
 	}
 
 	Napi::Value ReplaceFrame(const CallbackInfo& info) {
@@ -191,28 +226,23 @@ class RSFrameSet : public ObjectWrap<RSFrameSet> {
 
 		if (!this->frames_) return Boolean::New(info.Env(), false);
 
-		for (uint32_t i = 0; i < this->frame_count_; i++) {
-			rs2_frame* frame
-			  = GetNativeResult<rs2_frame*>(rs2_extract_frame, &this->error_, this->frames_, i, &this->error_);
-			if (!frame) continue;
+		auto slot = this->FindSlot(stream, stream_index);
+		if (!slot) return Boolean::New(info.Env(), false);
 
-			const rs2_stream_profile* profile = GetNativeResult<
-			  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &this->error_, frame, &this->error_);
-			if (profile) {
-				StreamProfileExtractor extrator(profile);
-				if (
-				  extrator.stream_ == stream && (!stream_index || (stream_index && stream_index == extrator.index_))) {
-					target_frame->Replace(frame);
-					return Boolean::New(info.Env(), true);
-				}
-			}
-			rs2_release_frame(frame);
-		}
+		CallNativeFunc(rs2_frame_add_ref, &this->error_, slot->frame, &this->error_);
+		if (this->error_) return Boolean::New(info.Env(), false);
 
-		return Boolean::New(info.Env(), false);
+		target_frame->Replace(slot->frame, slot->type);
+		return Boolean::New(info.Env(), true);
 	}
 };
 
-Napi::FunctionReference RSFrameSet::constructor;
+
+// Processing blocks return a frameset for frameset input and a single frame otherwise.
+Object NewFrameOrFrameSet(Napi::Env env, rs2_frame* frame) {
+	auto type = RSFrame::ClassifyFrame(frame);
+	return type & RSFrame::kTypeComposite ? RSFrameSet::NewInstance(env, frame)
+										  : RSFrame::NewInstance(env, frame, type);
+}
 
 #endif
@@ -147,10 +147,8 @@ export class FrameSet {
 
   private clearCache() {
     this.cache.forEach(f => {
-      if (f) {
-        f.getStreamProfile().destroy();
-        f.destroy();
-      }
+      // stream profiles are shared by every frame of their stream, so they are left alone
+      if (f) f.destroy();
     });
     this.cache = [];
     this.cacheMetadata = [];
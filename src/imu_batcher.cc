@@ -0,0 +1,350 @@
+#ifndef IMU_BATCHER_H
+#define IMU_BATCHER_H
+
+#include "addon_data.cc"
+#include "js_thread_signal.cc"
+#include "utils.cc"
+#include <chrono>
+#include <condition_variable>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <mutex>
+#include <napi.h>
+#include <thread>
+#include <vector>
+
+using namespace Napi;
+
+/**
+ * Accumulates motion samples on the librealsense callback thread into one of two buffers of
+ * (timestamp, x, y, z, stream) tuples. A buffer is handed to JS once it holds a full batch or its oldest
+ * sample is older than the latency bound, while the other buffer keeps filling. A timer thread enforces the
+ * bound when no new sample arrives. If JS still holds the previous batch when the filling buffer is full,
+ * new samples are dropped and counted.
+ */
+class ImuCollector {
+  public:
+	static const uint32_t kTupleSize = 5;
+
+	ImuCollector(uint32_t batch_size, uint32_t max_latency_ms, std::shared_ptr<JSThreadSignal> signal)
+	  : batch_size_(batch_size ? batch_size : 1)
+	  , capacity_(2 * batch_size_)
+	  , max_latency_(std::chrono::milliseconds(max_latency_ms))
+	  , signal_(signal)
+	  , fill_index_(0)
+	  , fill_count_(0)
+	  , ready_(false)
+	  , ready_index_(0)
+	  , ready_count_(0)
+	  , closed_(false)
+	  , dropped_(0) {
+		buffers_[0] = std::make_shared<std::vector<double>>(capacity_ * kTupleSize);
+		buffers_[1] = std::make_shared<std::vector<double>>(capacity_ * kTupleSize);
+		timer_		= std::thread(&ImuCollector::RunTimer, this);
+	}
+
+	~ImuCollector() {
+		Close();
+	}
+
+	std::shared_ptr<std::vector<double>> GetBuffer(int index) {
+		return buffers_[index];
+	}
+
+	// Called on the librealsense thread for every frame, framesets are unpacked.
+	void PushFrame(rs2_frame* frame) {
+		rs2_error* error = nullptr;
+		if (rs2_is_frame_extendable_to(frame, RS2_EXTENSION_COMPOSITE_FRAME, &error) && !error) {
+			auto count = rs2_embedded_frames_count(frame, &error);
+			for (int i = 0; i < count && !error; i++) {
+				auto embedded = rs2_extract_frame(frame, i, &error);
+				if (!embedded) continue;
+
+				PushFrame(embedded);
+				rs2_release_frame(embedded);
+			}
+		}
+		else if (!error && rs2_is_frame_extendable_to(frame, RS2_EXTENSION_MOTION_FRAME, &error) && !error) {
+			auto timestamp = rs2_get_frame_timestamp(frame, &error);
+			auto xyz	   = error ? nullptr : static_cast<const float*>(rs2_get_frame_data(frame, &error));
+			auto profile   = error ? nullptr : rs2_get_frame_stream_profile(frame, &error);
+
+			rs2_stream stream = RS2_STREAM_ANY;
+			rs2_format format = RS2_FORMAT_ANY;
+			int index		  = 0;
+			int unique_id	  = 0;
+			int fps			  = 0;
+			if (profile) rs2_get_stream_profile_data(profile, &stream, &format, &index, &unique_id, &fps, &error);
+			if (!error && xyz) Push(timestamp, xyz, stream);
+		}
+
+		if (error) rs2_free_error(error);
+	}
+
+	/**
+	 * Called on the JS thread; gives the buffer holding a batch ready for JS, or false. The buffer stays
+	 * untouched until Release() is called.
+	 */
+	bool Acquire(int* index, uint32_t* count) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!ready_) return false;
+
+		*index = ready_index_;
+		*count = ready_count_;
+		return true;
+	}
+
+	// Called on the JS thread once the batch from Acquire() has been consumed.
+	void Release() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			ready_ = false;
+			// Samples that piled up while JS was busy go out right away.
+			if (fill_count_ >= batch_size_) SwapLocked();
+		}
+		// A partial batch left behind is now up to the timer.
+		wake_.notify_one();
+	}
+
+	// Hands over whatever has been collected, even a partial batch. Returns false when nothing is pending.
+	bool Flush() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (ready_ || !fill_count_) return ready_;
+
+		SwapLocked();
+		return true;
+	}
+
+	// Must not be called on the timer thread.
+	void Close() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+		}
+		wake_.notify_all();
+		if (timer_.joinable()) timer_.join();
+	}
+
+	double Dropped() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return static_cast<double>(dropped_);
+	}
+
+  private:
+	void Push(double timestamp, const float* xyz, rs2_stream stream) {
+		bool signal = false;
+		bool first	= false;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (closed_) return;
+			if (fill_count_ == capacity_) {
+				dropped_++;
+				return;
+			}
+
+			auto now = std::chrono::steady_clock::now();
+			first	 = !fill_count_;
+			if (first) first_sample_ = now;
+
+			double* tuple = buffers_[fill_index_]->data() + fill_count_ * kTupleSize;
+			tuple[0]	  = timestamp;
+			tuple[1]	  = xyz[0];
+			tuple[2]	  = xyz[1];
+			tuple[3]	  = xyz[2];
+			tuple[4]	  = stream;
+			fill_count_++;
+
+			if (!ready_ && (fill_count_ >= batch_size_ || now - first_sample_ >= max_latency_)) {
+				SwapLocked();
+				signal = true;
+			}
+		}
+		if (signal) signal_->Signal();
+		if (first && !signal) wake_.notify_one();
+	}
+
+	// Hands over a partial batch once its oldest sample reaches the latency bound, without waiting for the next sample.
+	void RunTimer() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!closed_) {
+			wake_.wait(lock, [this] { return closed_ || (fill_count_ && !ready_); });
+			if (closed_) break;
+
+			auto deadline = first_sample_ + max_latency_;
+			wake_.wait_until(lock, deadline, [this] { return closed_; });
+			// The batch may have gone out or been replaced by a newer one meanwhile.
+			if (closed_ || ready_ || !fill_count_ || std::chrono::steady_clock::now() - first_sample_ < max_latency_)
+				continue;
+
+			SwapLocked();
+			lock.unlock();
+			signal_->Signal();
+			lock.lock();
+		}
+	}
+
+	void SwapLocked() {
+		ready_		 = true;
+		ready_index_ = fill_index_;
+		ready_count_ = fill_count_;
+		fill_index_ ^= 1;
+		fill_count_ = 0;
+	}
+
+	const uint32_t batch_size_;
+	const uint32_t capacity_;
+	const std::chrono::steady_clock::duration max_latency_;
+	std::shared_ptr<JSThreadSignal> signal_;
+	std::shared_ptr<std::vector<double>> buffers_[2];
+	int fill_index_;
+	uint32_t fill_count_;
+	std::chrono::steady_clock::time_point first_sample_;
+	bool ready_;
+	int ready_index_;
+	uint32_t ready_count_;
+	bool closed_;
+	uint64_t dropped_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::thread timer_;
+};
+
+class FrameCallbackForImuCollector : public rs2_frame_callback {
+  public:
+	explicit FrameCallbackForImuCollector(std::shared_ptr<ImuCollector> collector)
+	  : collector_(collector) {
+	}
+	void on_frame(rs2_frame* frame) override {
+		collector_->PushFrame(frame);
+		rs2_release_frame(frame);
+	}
+	void release() override {
+		delete this;
+	}
+	std::shared_ptr<ImuCollector> collector_;
+};
+
+class RSImuBatcher : public ObjectWrap<RSImuBatcher> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSImuBatcher",
+		  {
+			InstanceMethod("create", &RSImuBatcher::Create),
+			InstanceMethod("destroy", &RSImuBatcher::Destroy),
+			InstanceMethod("flush", &RSImuBatcher::Flush),
+			InstanceMethod("getDropped", &RSImuBatcher::GetDropped),
+		  });
+
+		AddonData::SetConstructor<RSImuBatcher>(env, func);
+		exports.Set("RSImuBatcher", func);
+
+		return exports;
+	}
+
+	RSImuBatcher(const CallbackInfo& info)
+	  : ObjectWrap<RSImuBatcher>(info)
+	  , collecting_(false) {
+	}
+
+	~RSImuBatcher() {
+		DestroyMe();
+	}
+
+  private:
+	friend class RSSensor;
+
+	std::shared_ptr<ImuCollector> collector_;
+	std::shared_ptr<JSThreadSignal> signal_;
+	ObjectReference arrays_[2];
+	bool collecting_;
+
+	static void ReleaseBuffer(Napi::Env, void*, std::shared_ptr<std::vector<double>>* hint) {
+		delete hint;
+	}
+
+	// The Float64Arrays share the native buffers, which live on until both the arrays and the collector are gone.
+	static Float64Array NewArray(Napi::Env env, std::shared_ptr<std::vector<double>> buffer) {
+		auto hint		  = new std::shared_ptr<std::vector<double>>(buffer);
+		auto byte_length  = buffer->size() * sizeof(double);
+		auto array_buffer = ArrayBuffer::New(env, buffer->data(), byte_length, ReleaseBuffer, hint);
+
+		return Float64Array::New(env, buffer->size(), array_buffer, 0);
+	}
+
+	static void DeliverBatches(Napi::Env env, Function callback, void* context) {
+		auto batcher   = static_cast<RSImuBatcher*>(context);
+		auto collector = batcher->collector_;
+		if (!collector) return;
+
+		int index	   = 0;
+		uint32_t count = 0;
+		while (collector->Acquire(&index, &count)) {
+			HandleScope scope(env);
+			try {
+				callback.Call({ batcher->arrays_[index].Value(), Number::New(env, count) });
+			}
+			catch (const Error& e) {
+				collector->Release();
+				e.ThrowAsJavaScriptException();
+				return;
+			}
+			collector->Release();
+		}
+	}
+
+	void DestroyMe() {
+		if (collector_) collector_->Close();
+		if (signal_) signal_->Stop();
+		collector_ = nullptr;
+		signal_	   = nullptr;
+		arrays_[0].Reset();
+		arrays_[1].Reset();
+
+		if (collecting_) this->Unref();
+		collecting_ = false;
+	}
+
+	/**
+	 * info[0] -> The function called with (batch: Float64Array, count: number). The batch holds count
+	 *            (timestamp, x, y, z, stream) tuples and is reused, so it must be consumed before returning.
+	 * info[1] -> Samples per batch, default to 64
+	 * info[2] -> Longest time in milliseconds a sample waits before its batch is delivered, default to 100
+	 */
+	Napi::Value Create(const CallbackInfo& info) {
+		if (!info[0].IsFunction()) return info.Env().Undefined();
+
+		auto batch_size		= info[1].IsNumber() ? info[1].ToNumber().Uint32Value() : 64;
+		auto max_latency_ms = info[2].IsNumber() ? info[2].ToNumber().Uint32Value() : 100;
+
+		this->DestroyMe();
+		this->signal_	 = std::make_shared<JSThreadSignal>();
+		this->collector_ = std::make_shared<ImuCollector>(batch_size, max_latency_ms, this->signal_);
+		for (int i = 0; i < 2; i++)
+			this->arrays_[i] = Napi::Persistent(Object(NewArray(info.Env(), this->collector_->GetBuffer(i))));
+		this->signal_->Start(info.Env(), info[0].As<Function>(), "RSImuBatcher", DeliverBatches, this);
+
+		// Batches keep the batcher alive until destroy(), even if JS drops every reference.
+		this->Ref();
+		this->collecting_ = true;
+		return info.This();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+
+	// Delivers the samples collected so far without waiting for the batch to fill, e.g. after sensor.stop().
+	Napi::Value Flush(const CallbackInfo& info) {
+		if (this->collector_ && this->collector_->Flush()) this->signal_->Signal();
+		return info.This();
+	}
+
+	Napi::Value GetDropped(const CallbackInfo& info) {
+		return Number::New(info.Env(), this->collector_ ? this->collector_->Dropped() : 0);
+	}
+};
+
+#endif
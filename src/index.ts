@@ -1,5 +1,7 @@
 export * from './addon';
 export * from './constants';
+export * from './frame-ring';
 export * from './frameset';
 export * from './pipeline';
+export * from './processing-graph';
 export * from './types';
@@ -0,0 +1,93 @@
+#ifndef JS_THREAD_SIGNAL_H
+#define JS_THREAD_SIGNAL_H
+
+#include <atomic>
+#include <mutex>
+#include <napi.h>
+
+using namespace Napi;
+
+/**
+ * Wakes the JS thread from any native thread through a thread-safe function.
+ *
+ * Unlike ThreadSafeCallback, a signal carries no payload and allocates nothing: the handler pulls whatever
+ * is pending from its context when it runs. Signals raised while a wake-up is already queued are
+ * coalesced into it, so the JS thread is woken at most once per turn however fast the producer is.
+ */
+class JSThreadSignal {
+  public:
+	typedef void (*Handler)(Napi::Env env, Function callback, void* context);
+
+	JSThreadSignal()
+	  : tsfn_(nullptr)
+	  , handler_(nullptr)
+	  , context_(nullptr)
+	  , pending_(false) {
+	}
+
+	~JSThreadSignal() {
+		Stop();
+	}
+
+	// Must be called on the JS thread.
+	bool Start(Napi::Env env, Function callback, const char* name, Handler handler, void* context) {
+		Stop();
+		handler_ = handler;
+		context_ = context;
+		pending_ = false;
+
+		napi_threadsafe_function tsfn = nullptr;
+		auto status					  = napi_create_threadsafe_function(
+		  env, callback, nullptr, String::New(env, name), 0, 1, nullptr, nullptr, this, CallJS, &tsfn);
+		if (status != napi_ok) return false;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		tsfn_ = tsfn;
+		return true;
+	}
+
+	// Safe to call from any thread, including after Stop().
+	void Signal() {
+		if (pending_.exchange(true)) return;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (tsfn_) napi_call_threadsafe_function(tsfn_, nullptr, napi_tsfn_nonblocking);
+	}
+
+	// Must be called on the JS thread. No handler runs after this returns.
+	void Stop() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (tsfn_) napi_release_threadsafe_function(tsfn_, napi_tsfn_abort);
+		tsfn_ = nullptr;
+	}
+
+	// Must be called on the JS thread. Pending wake-ups no longer keep the event loop alive.
+	void Unref(Napi::Env env) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (tsfn_) napi_unref_threadsafe_function(env, tsfn_);
+	}
+
+	bool IsActive() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return tsfn_ != nullptr;
+	}
+
+  private:
+	static void CallJS(napi_env env, napi_value callback, void* context, void* data) {
+		// A null env means the function is being torn down, and the owner may already be gone.
+		if (!env) return;
+
+		auto self = static_cast<JSThreadSignal*>(context);
+		// Cleared before the handler runs, so anything pushed while it drains schedules another turn.
+		self->pending_ = false;
+		self->handler_(Napi::Env(env), Function(env, callback), self->context_);
+	}
+
+	napi_threadsafe_function tsfn_;
+	Handler handler_;
+	void* context_;
+	std::atomic<bool> pending_;
+	std::mutex mutex_;
+};
+
+#endif
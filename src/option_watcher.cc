@@ -0,0 +1,141 @@
+#ifndef OPTION_WATCHER_H
+#define OPTION_WATCHER_H
+
+#include "js_thread_signal.cc"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <map>
+#include <mutex>
+#include <napi.h>
+#include <thread>
+#include <vector>
+
+using namespace Napi;
+
+/**
+ * Polls a set of options on its own thread, so USB control transfers never block the JS thread, and hands
+ * JS only the options whose value changed, batched per wake-up. The first poll sets the baseline and
+ * reports nothing. Options that fail to read keep their last value until a later read succeeds.
+ */
+class OptionWatcher {
+  public:
+	// Every poll is one USB control transfer per option, so polling faster than this is refused.
+	static const uint32_t kMinIntervalMs	 = 10;
+	static const uint32_t kDefaultIntervalMs = 100;
+
+	OptionWatcher(rs2_options* options, const std::vector<rs2_option>& watched, uint32_t interval_ms)
+	  : options_(options)
+	  , watched_(watched)
+	  , last_(watched.size(), 0)
+	  , known_(watched.size(), false)
+	  , interval_(std::chrono::milliseconds(std::max(interval_ms, kMinIntervalMs)))
+	  , stopping_(false) {
+	}
+
+	~OptionWatcher() {
+		Stop();
+	}
+
+	// Must be called on the JS thread.
+	bool Start(Napi::Env env, Function callback) {
+		if (!signal_.Start(env, callback, "RSOptionWatcher", DeliverChanges, this)) return false;
+
+		thread_ = std::thread(&OptionWatcher::Run, this);
+		return true;
+	}
+
+	// Must be called on the JS thread, and before the options pointer goes away.
+	void Stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wake_.notify_all();
+		if (thread_.joinable()) thread_.join();
+		signal_.Stop();
+	}
+
+  private:
+	void Run() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!stopping_) {
+			lock.unlock();
+			bool changed = Poll();
+			if (changed) signal_.Signal();
+			lock.lock();
+
+			wake_.wait_for(lock, interval_, [this] { return stopping_; });
+		}
+	}
+
+	// Only the polling thread touches last_ and known_.
+	bool Poll() {
+		bool changed = false;
+		for (size_t i = 0; i < watched_.size(); i++) {
+			rs2_error* error = nullptr;
+			auto value		 = rs2_get_option(options_, watched_[i], &error);
+			if (error) {
+				rs2_free_error(error);
+				continue;
+			}
+			if (known_[i] && value == last_[i]) continue;
+
+			if (known_[i]) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				// A newer value replaces one JS has not seen yet.
+				changes_[watched_[i]] = value;
+				changed				  = true;
+			}
+			last_[i]  = value;
+			known_[i] = true;
+		}
+		return changed;
+	}
+
+	static void DeliverChanges(Napi::Env env, Function callback, void* context) {
+		auto watcher = static_cast<OptionWatcher*>(context);
+		std::map<rs2_option, float> changes;
+		{
+			std::lock_guard<std::mutex> lock(watcher->mutex_);
+			changes.swap(watcher->changes_);
+		}
+		if (changes.empty()) return;
+
+		HandleScope scope(env);
+		auto ids	= Int32Array::New(env, changes.size());
+		auto values = Float32Array::New(env, changes.size());
+		size_t i	= 0;
+		for (const auto& change : changes) {
+			ids[i]	  = change.first;
+			values[i] = change.second;
+			i++;
+		}
+
+		try {
+			callback.Call({ ids, values });
+		}
+		catch (const Error& e) {
+			e.ThrowAsJavaScriptException();
+		}
+	}
+
+	rs2_options* options_;
+	const std::vector<rs2_option> watched_;
+	std::vector<float> last_;
+	std::vector<bool> known_;
+	const std::chrono::steady_clock::duration interval_;
+	bool stopping_;
+	std::map<rs2_option, float> changes_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::thread thread_;
+	JSThreadSignal signal_;
+};
+
+// std::max and the conditional in RSSensor::WatchOptions bind these by reference, so they need a definition.
+const uint32_t OptionWatcher::kMinIntervalMs;
+const uint32_t OptionWatcher::kDefaultIntervalMs;
+
+#endif
@@ -3,19 +3,29 @@
 
 #include "dicts.cc"
 #include "utils.cc"
+#include <algorithm>
 #include <librealsense2/hpp/rs_types.hpp>
 #include <napi.h>
+#include <vector>
 
 using namespace Napi;
 
 class Options {
   public:
+	// Per-option result of applyOptions, mirrored by RSOptionApplyStatus in constants.ts
+	enum ApplyStatus {
+		kApplyUnchanged	  = 0,
+		kApplySet		  = 1,
+		kApplyUnsupported = -1,
+		kApplyReadOnly	  = -2,
+		kApplyFailed	  = -3
+	};
+
 	Options()
 	  : error_(nullptr) {
 	}
 
 	virtual ~Options() {
-		if (error_) rs2_free_error(error_);
 	}
 
 	virtual rs2_options* GetOptionsPointer() = 0;
@@ -60,7 +70,7 @@ class Options {
 
 	Napi::Value SetOptionInternal(const CallbackInfo& info) {
 		int32_t option = info[0].ToNumber().Int32Value();
-		auto val	   = info[1].ToNumber().Int32Value();
+		auto val	   = info[1].ToNumber().FloatValue();
 		CallNativeFunc(rs2_set_option, &error_, GetOptionsPointer(), static_cast<rs2_option>(option), val, &error_);
 		return info.Env().Undefined();
 	}
@@ -93,6 +103,90 @@ class Options {
 		return Boolean::New(info.Env(), val ? true : false);
 	}
 
+	/**
+	 * Returns { ids: Int32Array, values: Float32Array } for every supported option, read in one pass.
+	 */
+	Napi::Value GetAllOptionsInternal(const CallbackInfo& info) {
+		auto options = GetOptionsPointer();
+		std::vector<int32_t> ids;
+		std::vector<float> values;
+		ErrorUtil::ResetError();
+		for (int32_t id = 0; options && id < RS2_OPTION_COUNT; id++) {
+			auto option		 = static_cast<rs2_option>(id);
+			rs2_error* error = nullptr;
+			if (rs2_supports_option(options, option, &error) && !error) {
+				auto value = rs2_get_option(options, option, &error);
+				if (!error) {
+					ids.push_back(id);
+					values.push_back(value);
+				}
+			}
+			// An option that cannot be read right now is left out of the snapshot.
+			if (error) rs2_free_error(error);
+		}
+
+		auto id_array	 = Int32Array::New(info.Env(), ids.size());
+		auto value_array = Float32Array::New(info.Env(), values.size());
+		std::copy(ids.begin(), ids.end(), id_array.Data());
+		std::copy(values.begin(), values.end(), value_array.Data());
+
+		auto result = Object::New(info.Env());
+		result.Set("ids", id_array);
+		result.Set("values", value_array);
+		return result;
+	}
+
+	/**
+	 * info[0] -> Int32Array of option ids
+	 * info[1] -> Float32Array of the values to apply, one per id
+	 *
+	 * Only options whose current value differs are written. Returns an Int32Array with an ApplyStatus per
+	 * option; the first failure is also reported through the registered error callback.
+	 */
+	Napi::Value ApplyOptionsInternal(const CallbackInfo& info) {
+		if (!info[0].IsTypedArray() || !info[1].IsTypedArray()) return info.Env().Undefined();
+
+		auto ids	= info[0].As<Int32Array>();
+		auto values = info[1].As<Float32Array>();
+		if (ids.TypedArrayType() != napi_int32_array || values.TypedArrayType() != napi_float32_array)
+			return info.Env().Undefined();
+
+		auto options = GetOptionsPointer();
+		auto count	 = std::min(ids.ElementLength(), values.ElementLength());
+		auto status	 = Int32Array::New(info.Env(), count);
+		rs2_error* first_error = nullptr;
+		ErrorUtil::ResetError();
+		for (size_t i = 0; i < count; i++) {
+			auto option		 = static_cast<rs2_option>(ids[i]);
+			auto value		 = values[i];
+			rs2_error* error = nullptr;
+			if (!options || ids[i] < 0 || ids[i] >= RS2_OPTION_COUNT || !rs2_supports_option(options, option, &error)) {
+				status[i] = error ? kApplyFailed : kApplyUnsupported;
+			}
+			else if (rs2_get_option(options, option, &error) == value && !error) {
+				status[i] = kApplyUnchanged;
+			}
+			else if (!error && rs2_is_option_read_only(options, option, &error) && !error) {
+				status[i] = kApplyReadOnly;
+			}
+			else if (!error) {
+				rs2_set_option(options, option, value, &error);
+				status[i] = error ? kApplyFailed : kApplySet;
+			}
+			else {
+				status[i] = kApplyFailed;
+			}
+
+			if (error && !first_error)
+				first_error = error;
+			else if (error)
+				rs2_free_error(error);
+		}
+
+		if (first_error) ErrorUtil::AnalyzeError(first_error);
+		return status;
+	}
+
   private:
 	rs2_error* error_;
 };
@@ -1,10 +1,18 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
+#include "addon_data.cc"
 #include "context.cc"
+#include "dicts.cc"
+#include "frame_bus.cc"
+#include "frame_callbacks.cc"
+#include "frame_publisher.cc"
 #include "pipeline_profile.cc"
+#include <atomic>
 #include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
 #include <napi.h>
+#include <vector>
 
 using namespace Napi;
 
@@ -18,14 +26,18 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 			InstanceMethod("create", &RSPipeline::Create),
 			InstanceMethod("destroy", &RSPipeline::Destroy),
 			InstanceMethod("getActiveProfile", &RSPipeline::GetActiveProfile),
+			InstanceMethod("getFrameQueueStats", &RSPipeline::GetFrameQueueStats),
 			InstanceMethod("pollForFrames", &RSPipeline::PollForFrames),
 			InstanceMethod("start", &RSPipeline::Start),
+			InstanceMethod("startWithCallback", &RSPipeline::StartWithCallback),
+			InstanceMethod("startWithFrameBus", &RSPipeline::StartWithFrameBus),
+			InstanceMethod("startWithFramePublisher", &RSPipeline::StartWithFramePublisher),
 			InstanceMethod("stop", &RSPipeline::Stop),
 			InstanceMethod("waitForFrames", &RSPipeline::WaitForFrames),
+			InstanceMethod("waitForFramesAsync", &RSPipeline::WaitForFramesAsync),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSPipeline>(env, func);
 		exports.Set("RSPipeline", func);
 
 		return exports;
@@ -33,7 +45,7 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 
 	static Object NewInstance(Napi::Env env) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSPipeline>(env).New({});
 
 		return scope.Escape(napi_value(instance)).ToObject();
 	}
@@ -41,7 +53,11 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 	RSPipeline(const CallbackInfo& info)
 	  : ObjectWrap<RSPipeline>(info)
 	  , pipeline_(nullptr)
-	  , error_(nullptr) {
+	  , error_(nullptr)
+	  , wait_pending_(false)
+	  , waits_in_flight_(0)
+	  , delivering_frames_(false)
+	  , callback_streaming_(false) {
 	}
 
 	~RSPipeline() {
@@ -50,17 +66,189 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 
   private:
 	friend class RSConfig;
-
-	static FunctionReference constructor;
+	friend class RSProcessingGraph;
+
+	/**
+	 * Waits for a frameset on the libuv thread pool and settles the promise returned by waitForFramesAsync.
+	 * The wait is sliced so that a cancelled wait notices within one slice. Each worker captures the native
+	 * pipeline and its own cancel flag, so stop() and destroy() never block on it and a later wait is not
+	 * mistaken for the cancelled one.
+	 */
+	class WaitForFramesWorker : public AsyncWorker {
+	  public:
+		WaitForFramesWorker(Napi::Env env, RSPipeline* pipeline, Object holder, uint32_t timeout)
+		  : AsyncWorker(env, "RSPipeline::WaitForFramesAsync")
+		  , deferred_(Promise::Deferred::New(env))
+		  , holder_(Napi::Persistent(holder))
+		  , pipeline_(pipeline)
+		  , rs_pipeline_(pipeline->pipeline_)
+		  , cancelled_(pipeline->wait_cancel_)
+		  , timeout_(timeout)
+		  , frames_(nullptr)
+		  , error_(nullptr) {
+		}
+
+		Napi::Promise GetPromise() const {
+			return deferred_.Promise();
+		}
+
+	  protected:
+		void Execute() override {
+			const uint32_t slice = 100;
+			uint32_t remaining	 = timeout_;
+
+			while (!*cancelled_) {
+				const uint32_t wait = remaining < slice ? remaining : slice;
+				if (rs2_pipeline_try_wait_for_frames(rs_pipeline_, &frames_, wait, &error_) || error_) break;
+				if (remaining <= slice) break;
+
+				remaining -= slice;
+			}
+		}
+
+		void OnOK() override {
+			pipeline_->FinishWait();
+
+			if (*cancelled_) {
+				// The pipeline was stopped or destroyed meanwhile, anything that arrived is no longer wanted.
+				if (frames_) rs2_release_frame(frames_);
+				if (error_) rs2_free_error(error_);
+				deferred_.Resolve(Env().Undefined());
+				return;
+			}
+
+			pipeline_->wait_pending_ = false;
+			if (error_) {
+				// Release any frames that may have arrived with the error, then surface it on the JS thread.
+				if (frames_) rs2_release_frame(frames_);
+				deferred_.Reject(Error::New(Env(), rs2_get_error_message(error_)).Value());
+				ErrorUtil::AnalyzeRejectedError(error_);
+				return;
+			}
+			if (!frames_) {
+				deferred_.Resolve(Env().Undefined());
+				return;
+			}
+
+			deferred_.Resolve(RSFrameSet::NewInstance(Env(), frames_));
+		}
+
+		void OnError(const Napi::Error& e) override {
+			pipeline_->FinishWait();
+			if (!*cancelled_) pipeline_->wait_pending_ = false;
+			if (frames_) rs2_release_frame(frames_);
+			if (error_) rs2_free_error(error_);
+			deferred_.Reject(e.Value());
+		}
+
+	  private:
+		Promise::Deferred deferred_;
+		ObjectReference holder_;
+		RSPipeline* pipeline_;
+		rs2_pipeline* rs_pipeline_;
+		std::shared_ptr<std::atomic<bool>> cancelled_;
+		uint32_t timeout_;
+		rs2_frame* frames_;
+		rs2_error* error_;
+	};
 
 	rs2_pipeline* pipeline_;
 	rs2_error* error_;
+	// Cancel flag of the pending wait, shared with its worker
+	std::shared_ptr<std::atomic<bool>> wait_cancel_;
+	bool wait_pending_;
+	// Wait workers queued or running, including cancelled ones
+	uint32_t waits_in_flight_;
+	// Native pipelines destroyed while a wait worker could still be using them
+	std::vector<rs2_pipeline*> retired_pipelines_;
+	std::shared_ptr<BoundedFrameQueue> frame_queue_;
+	std::shared_ptr<JSThreadSignal> frame_signal_;
+	bool delivering_frames_;
+	// Set while a frame callback of any kind is installed, until stop() or destroy()
+	bool callback_streaming_;
+
+	// Runs on the JS thread whenever the frame callback has queued at least one frameset.
+	static void DeliverFrames(Napi::Env env, Function callback, void* context) {
+		auto pipeline = static_cast<RSPipeline*>(context);
+		auto queue	  = pipeline->frame_queue_;
+		if (!queue) return;
+
+		rs2_frame* frames = nullptr;
+		while (queue->TryPop(&frames)) {
+			HandleScope scope(env);
+			try {
+				callback.Call({ RSFrameSet::NewInstance(env, frames) });
+			}
+			catch (const Error& e) {
+				e.ThrowAsJavaScriptException();
+				return;
+			}
+		}
+	}
+
+	/**
+	 * config is an optional RSConfig. A second start fails up front, before anything that belongs to the
+	 * running callback is touched, as librealsense would keep feeding the old callback's queue or ring.
+	 */
+	rs2_pipeline_profile* StartWithFrameCallback(rs2_frame_callback* callback, Napi::Value config) {
+		if (this->callback_streaming_) {
+			callback->release();
+			Error::New(config.Env(), "The pipeline is already streaming, stop() it first").ThrowAsJavaScriptException();
+			return nullptr;
+		}
+
+		auto profile
+		  = !config.IsObject()
+			  ? GetNativeResult<rs2_pipeline_profile*>(
+				rs2_pipeline_start_with_callback_cpp, &this->error_, this->pipeline_, callback, &this->error_)
+			  : GetNativeResult<rs2_pipeline_profile*>(
+				rs2_pipeline_start_with_config_and_callback_cpp,
+				&this->error_,
+				this->pipeline_,
+				ObjectWrap<RSConfig>::Unwrap(config.ToObject())->config_,
+				callback,
+				&this->error_);
+		if (profile) this->callback_streaming_ = true;
+
+		return profile;
+	}
+
+	void StopFrameDelivery() {
+		if (this->frame_signal_) this->frame_signal_->Stop();
+		if (this->frame_queue_) this->frame_queue_->Clear();
+		this->frame_signal_ = nullptr;
+		this->frame_queue_	= nullptr;
+
+		if (this->delivering_frames_) this->Unref();
+		this->delivering_frames_ = false;
+	}
+
+	// Flags the pending wait as cancelled without waiting for its worker, which settles it on its own.
+	void CancelWait() {
+		if (this->wait_cancel_) *this->wait_cancel_ = true;
+		this->wait_cancel_	= nullptr;
+		this->wait_pending_ = false;
+	}
+
+	// Called on the JS thread as each wait worker settles.
+	void FinishWait() {
+		if (--this->waits_in_flight_ > 0) return;
+
+		for (auto pipeline : this->retired_pipelines_) rs2_delete_pipeline(pipeline);
+		this->retired_pipelines_.clear();
+	}
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
+		CancelWait();
+		// A producer blocked on a full queue must be released before the pipeline can stop.
+		if (frame_queue_) frame_queue_->Close();
 		error_ = nullptr;
-		if (pipeline_) rs2_delete_pipeline(pipeline_);
+		// A wait worker may still be inside librealsense with this pipeline; the last one to settle deletes it.
+		if (pipeline_ && waits_in_flight_) retired_pipelines_.push_back(pipeline_);
+		else if (pipeline_) rs2_delete_pipeline(pipeline_);
 		pipeline_ = nullptr;
+		StopFrameDelivery();
+		callback_streaming_ = false;
 	}
 
 	Napi::Value Create(const CallbackInfo& info) {
@@ -87,6 +275,12 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 		return RSPipelineProfile::NewInstance(info.Env(), prof);
 	}
 
+	Napi::Value GetFrameQueueStats(const CallbackInfo& info) {
+		if (!this->frame_queue_) return info.Env().Undefined();
+
+		return RSFrameQueueStats(info.Env(), this->frame_queue_->GetStats()).GetObject();
+	}
+
 	Napi::Value PollForFrames(const CallbackInfo& info) {
 		auto frameset = ObjectWrap<RSFrameSet>::Unwrap(info[0].ToObject());
 		if (!frameset) return Boolean::New(info.Env(), false);
@@ -116,8 +310,80 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 		return RSPipelineProfile::NewInstance(info.Env(), profile);
 	}
 
+	/**
+	 * info[0] -> The function called with each RSFrameSet
+	 * info[1] -> Optional RSConfig
+	 * info[2] -> Optional { policy: 'latest-only' | 'drop-oldest' | 'block', capacity: number }
+	 */
+	Napi::Value StartWithCallback(const CallbackInfo& info) {
+		if (!this->pipeline_ || !info[0].IsFunction()) return info.Env().Undefined();
+
+		auto policy		  = BoundedFrameQueue::kLatestOnly;
+		uint32_t capacity = 1;
+		if (info[2].IsObject()) {
+			auto options = info[2].ToObject();
+			if (options.Has("policy") && !BoundedFrameQueue::ParsePolicy(options.Get("policy").ToString(), &policy)) {
+				TypeError::New(info.Env(), "Unknown frame queue policy").ThrowAsJavaScriptException();
+				return info.Env().Undefined();
+			}
+			if (options.Has("capacity")) capacity = options.Get("capacity").ToNumber().Uint32Value();
+		}
+
+		// The queue and signal only replace the current ones once the pipeline has started with them.
+		auto queue	= std::make_shared<BoundedFrameQueue>(policy, capacity);
+		auto signal = std::make_shared<JSThreadSignal>();
+		signal->Start(info.Env(), info[0].As<Function>(), "RSPipeline::StartWithCallback", DeliverFrames, this);
+
+		auto profile = this->StartWithFrameCallback(new FrameCallbackForBoundedQueue(queue, signal), info[1]);
+		if (!profile) {
+			queue->Close();
+			signal->Stop();
+			return info.Env().Undefined();
+		}
+
+		this->StopFrameDelivery();
+		this->frame_queue_	= queue;
+		this->frame_signal_ = signal;
+		// Streaming keeps the pipeline alive until stop() or destroy(), even if JS drops every reference.
+		this->Ref();
+		this->delivering_frames_ = true;
+		return RSPipelineProfile::NewInstance(info.Env(), profile);
+	}
+
+	/**
+	 * info[0] -> RSFrameBus publishing every frame of its streams to other processes, without involving JS
+	 * info[1] -> Optional RSConfig
+	 */
+	Napi::Value StartWithFrameBus(const CallbackInfo& info) {
+		auto bus = info[0].IsObject() ? ObjectWrap<RSFrameBus>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!this->pipeline_ || !bus || !bus->ring_) return info.Env().Undefined();
+
+		auto profile = this->StartWithFrameCallback(new FrameCallbackForFrameRing(bus->ring_), info[1]);
+		if (!profile) return info.Env().Undefined();
+
+		return RSPipelineProfile::NewInstance(info.Env(), profile);
+	}
+
+	/**
+	 * info[0] -> RSFramePublisher writing every frame of its streams into its ring, without involving JS
+	 * info[1] -> Optional RSConfig
+	 */
+	Napi::Value StartWithFramePublisher(const CallbackInfo& info) {
+		auto publisher = info[0].IsObject() ? ObjectWrap<RSFramePublisher>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!this->pipeline_ || !publisher || !publisher->ring_) return info.Env().Undefined();
+
+		auto profile = this->StartWithFrameCallback(new FrameCallbackForFrameRing(publisher->ring_), info[1]);
+		if (!profile) return info.Env().Undefined();
+
+		return RSPipelineProfile::NewInstance(info.Env(), profile);
+	}
+
 	Napi::Value Stop(const CallbackInfo& info) {
+		this->CancelWait();
+		if (this->frame_queue_) this->frame_queue_->Close();
 		CallNativeFunc(rs2_pipeline_stop, &this->error_, this->pipeline_, &this->error_);
+		this->StopFrameDelivery();
+		this->callback_streaming_ = false;
 		return info.This();
 	}
 
@@ -125,8 +391,6 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 		// auto frameset = ObjectWrap<RSFrameSet>::Unwrap(info[0].ToObject());
 		auto timeout = info[1].IsNumber() ? info[1].ToNumber().Int32Value() : 5000;
 
-        std::cerr << "Waiting for frames for a maximum time of " << timeout << std::endl;
-
 		rs2_frame* frames = GetNativeResult<
 		  rs2_frame*>(rs2_pipeline_wait_for_frames, &this->error_, this->pipeline_, timeout, &this->error_);
 		// if (!frames) return Boolean::New(info.Env(), false);
@@ -136,6 +400,25 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 		return frameset;
         // Boolean::New(info.Env(), true);
 	}
+	Napi::Value WaitForFramesAsync(const CallbackInfo& info) {
+		auto timeout = info[0].IsNumber() ? info[0].ToNumber().Uint32Value() : 5000;
+
+		if (!this->pipeline_ || this->wait_pending_) {
+			auto deferred = Promise::Deferred::New(info.Env());
+			auto message  = this->pipeline_ ? "A wait for frames is already pending" : "Pipeline is not created";
+			deferred.Reject(Error::New(info.Env(), message).Value());
+			return deferred.Promise();
+		}
+
+		this->wait_cancel_	= std::make_shared<std::atomic<bool>>(false);
+		this->wait_pending_ = true;
+		this->waits_in_flight_++;
+
+		auto worker = new WaitForFramesWorker(info.Env(), this, info.This().ToObject(), timeout);
+		worker->Queue();
+		return worker->GetPromise();
+	}
+
 	// Napi::Value WaitForFrames(const CallbackInfo& info) {
 	// 	auto frameset = ObjectWrap<RSFrameSet>::Unwrap(info[0].ToObject());
 	// 	auto timeout = info[1].IsNumber() ? info[1].ToNumber().Int32Value() : 5000;
@@ -149,6 +432,4 @@ class RSPipeline : public ObjectWrap<RSPipeline> {
 	// }
 };
 
-Napi::FunctionReference RSPipeline::constructor;
-
 #endif
@@ -1,6 +1,7 @@
 import { addon, deleteAutomatically } from './addon';
-import { RSPipeline, RSConfig } from './types';
+import { RSPipeline, RSConfig, RSFrame, RSFrameBus, RSFramePublisher, RSFrameQueueOptions } from './types';
 import { FrameSet } from './frameset';
+import { ProcessingGraph } from './processing-graph';
 import { PipelineProfile } from './pipeline-profile';
 
 export class Pipeline {
@@ -19,6 +20,7 @@ export class Pipeline {
   private readonly cxxPipeline: RSPipeline;
   private readonly frameSet: FrameSet;
   private started: boolean;
+  private graph?: ProcessingGraph;
 
   constructor(
     private readonly ctx = new addon.RSContext()
@@ -50,13 +52,115 @@ export class Pipeline {
     return new PipelineProfile(this.cxxPipeline.start(config));
   }
 
+  /**
+   * Start streaming and push every frameset to a callback instead of polling.
+   * Framesets are buffered in a native bounded queue between the librealsense thread and JS; the
+   * queue policy decides whether a slow consumer drops the oldest frames, keeps only the latest one,
+   * or blocks the device. See {@link Pipeline.frameQueueStats} for depth and drop counters.
+   *
+   * @param {Function} callback - called on the JS thread with each FrameSet
+   * @param {RSConfig} [config] - stream configuration
+   * @param {RSFrameQueueOptions} [options] - queue policy and capacity, default to latest-only
+   */
+  startWithCallback(
+    callback: (frameSet: FrameSet) => void,
+    config?: RSConfig,
+    options?: RSFrameQueueOptions
+  ) {
+    if (this.started === true) return undefined;
+
+    const profile = this.cxxPipeline.startWithCallback(
+      frames => callback(new FrameSet(frames)),
+      config,
+      options
+    );
+    if (!profile) return undefined;
+
+    this.started = true;
+    return new PipelineProfile(profile);
+  }
+
+  /**
+   * Start streaming into the shared memory ring of an RSFrameBus, which other processes on this host
+   * read through an RSFrameBusSubscriber. Frames never reach the JS thread.
+   *
+   * @param {RSFrameBus} bus - created with the name, ring size and streams to publish
+   * @param {RSConfig} [config] - stream configuration
+   */
+  startWithFrameBus(
+    bus: RSFrameBus,
+    config?: RSConfig
+  ) {
+    if (this.started === true) return undefined;
+
+    const profile = this.cxxPipeline.startWithFrameBus(bus, config);
+    if (!profile) return undefined;
+
+    this.started = true;
+    return new PipelineProfile(profile);
+  }
+
+  /**
+   * Start streaming straight into the ring of an RSFramePublisher, which lives in a SharedArrayBuffer
+   * that workers read with {@link FrameRingReader}. Frames never reach the JS thread.
+   *
+   * @param {RSFramePublisher} publisher - created over the ring memory, with the streams to publish
+   * @param {RSConfig} [config] - stream configuration
+   */
+  startWithFramePublisher(
+    publisher: RSFramePublisher,
+    config?: RSConfig
+  ) {
+    if (this.started === true) return undefined;
+
+    const profile = this.cxxPipeline.startWithFramePublisher(publisher, config);
+    if (!profile) return undefined;
+
+    this.started = true;
+    return new PipelineProfile(profile);
+  }
+
+  /**
+   * Start streaming into a {@link ProcessingGraph}. Every stage runs on a native worker thread and
+   * the callback only receives the output of the last stage: a FrameSet, or a single frame when the
+   * last stage produces one.
+   *
+   * @param {ProcessingGraph} graph - the stages to run on each frameset
+   * @param {Function} callback - called on the JS thread with each processed result
+   * @param {RSConfig} [config] - stream configuration
+   */
+  startWithProcessingGraph(
+    graph: ProcessingGraph,
+    callback: (frames: FrameSet | RSFrame) => void,
+    config?: RSConfig
+  ) {
+    if (this.started === true) return undefined;
+
+    const profile = graph.start(
+      this.cxxPipeline,
+      frames => callback('getSize' in frames ? new FrameSet(frames) : frames),
+      config
+    );
+    if (!profile) return undefined;
+
+    this.started = true;
+    this.graph = graph;
+    return new PipelineProfile(profile);
+  }
+
+  get frameQueueStats() {
+    return this.cxxPipeline.getFrameQueueStats();
+  }
+
   /**
    * Stop streaming
    */
   stop() {
     if (this.started === false) return;
 
-    this.cxxPipeline.stop();
+    if (this.graph) this.graph.stop();
+    else this.cxxPipeline.stop();
+    this.graph = undefined;
     this.started = false;
     this.frameSet.destroy();
   }
@@ -82,6 +186,21 @@ export class Pipeline {
     return undefined;
   }
 
+  /**
+   * Wait for the next set of frames without blocking the event loop.
+   * The wait runs on a native worker thread; only one wait may be outstanding per pipeline.
+   * A pending wait is cancelled by {@link Pipeline.stop}, in which case the promise resolves to
+   * undefined, as it does when the timeout expires.
+   *
+   * @param {Integer} timeout - max time to wait, in milliseconds, default to 5000 ms
+   * @return {Promise<FrameSet|undefined>}
+   */
+  async waitForFramesAsync(timeout?: number) {
+    const frames = await this.cxxPipeline.waitForFramesAsync(timeout);
+
+    return frames ? new FrameSet(frames) : undefined;
+  }
+
   get latestFrame() {
     return this.frameSet;
   }
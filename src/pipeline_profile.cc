@@ -1,6 +1,7 @@
 #ifndef PIPELINE_PROFILE_H
 #define PIPELINE_PROFILE_H
 
+#include "addon_data.cc"
 #include "config.cc"
 #include "device.cc"
 #include "utils.cc"
@@ -21,8 +22,7 @@ class RSPipelineProfile : public ObjectWrap<RSPipelineProfile> {
 			InstanceMethod("getStreams", &RSPipelineProfile::GetStreams),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSPipelineProfile>(env, func);
 		exports.Set("RSPipelineProfile", func);
 
 		return exports;
@@ -30,7 +30,7 @@ class RSPipelineProfile : public ObjectWrap<RSPipelineProfile> {
 
 	static Object NewInstance(Napi::Env env, rs2_pipeline_profile* profile) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSPipelineProfile>(env).New({});
 
 		auto unwrapped				 = ObjectWrap<RSPipelineProfile>::Unwrap(instance);
 		unwrapped->pipeline_profile_ = profile;
@@ -49,13 +49,10 @@ class RSPipelineProfile : public ObjectWrap<RSPipelineProfile> {
 	}
 
   private:
-	static FunctionReference constructor;
-
 	rs2_pipeline_profile* pipeline_profile_;
 	rs2_error* error_;
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 
 		if (pipeline_profile_) rs2_delete_pipeline_profile(pipeline_profile_);
@@ -95,6 +92,4 @@ class RSPipelineProfile : public ObjectWrap<RSPipelineProfile> {
 	}
 };
 
-Napi::FunctionReference RSPipelineProfile::constructor;
-
 #endif
@@ -0,0 +1,231 @@
+#ifndef POINTCLOUD_H
+#define POINTCLOUD_H
+
+#include "addon_data.cc"
+#include "frame.cc"
+#include "frame_callbacks.cc"
+#include "options.cc"
+#include "processing_blocks.cc"
+#include "utils.cc"
+#include <cstring>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <napi.h>
+
+using namespace Napi;
+
+class RSPointCloud
+  : public ObjectWrap<RSPointCloud>
+  , Options {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSPointCloud",
+		  {
+			InstanceMethod("applyOptions", &RSPointCloud::ApplyOptions),
+			InstanceMethod("calculate", &RSPointCloud::Calculate),
+			InstanceMethod("destroy", &RSPointCloud::Destroy),
+			InstanceMethod("getAllOptions", &RSPointCloud::GetAllOptions),
+			InstanceMethod("getOption", &RSPointCloud::GetOption),
+			InstanceMethod("getOptionDescription", &RSPointCloud::GetOptionDescription),
+			InstanceMethod("getOptionRange", &RSPointCloud::GetOptionRange),
+			InstanceMethod("getOptionValueDescription", &RSPointCloud::GetOptionValueDescription),
+			InstanceMethod("isOptionReadonly", &RSPointCloud::IsOptionReadonly),
+			InstanceMethod("mapTo", &RSPointCloud::MapTo),
+			InstanceMethod("setOption", &RSPointCloud::SetOption),
+			InstanceMethod("supportsOption", &RSPointCloud::SupportsOption),
+		  });
+
+		AddonData::SetConstructor<RSPointCloud>(env, func);
+		exports.Set("RSPointCloud", func);
+
+		return exports;
+	}
+
+	rs2_options* GetOptionsPointer() override {
+		return reinterpret_cast<rs2_options*>(block_);
+	}
+
+	RSPointCloud(const CallbackInfo& info)
+	  : ObjectWrap<RSPointCloud>(info)
+	  , block_(nullptr)
+	  , frame_queue_(nullptr)
+	  , error_(nullptr) {
+		this->block_ = CreateProcessingBlock("pointcloud", RS2_STREAM_ANY, &this->error_);
+		if (!this->block_) return;
+
+		this->frame_queue_ = GetNativeResult<rs2_frame_queue*>(rs2_create_frame_queue, &this->error_, 1, &this->error_);
+		if (!this->frame_queue_) return;
+
+		auto callback = new FrameCallbackForFrameQueue(this->frame_queue_);
+		CallNativeFunc(rs2_start_processing, &this->error_, this->block_, callback, &this->error_);
+	}
+
+	~RSPointCloud() {
+		DestroyMe();
+	}
+
+  private:
+	rs2_processing_block* block_;
+	rs2_frame_queue* frame_queue_;
+	rs2_error* error_;
+
+	void DestroyMe() {
+		error_ = nullptr;
+		if (block_) rs2_delete_processing_block(block_);
+		block_ = nullptr;
+		if (frame_queue_) rs2_delete_frame_queue(frame_queue_);
+		frame_queue_ = nullptr;
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+
+	/**
+	 * Runs a frame through the block and returns whatever it produced, the caller owns the result.
+	 * Every check that can fail comes before the input is add-ref'd, since rs2_process_frame takes over that
+	 * reference once it is called, even when it fails, and nothing must return while holding it before that.
+	 */
+	rs2_frame* ProcessFrame(RSFrame* frame) {
+		if (!this->block_ || !this->frame_queue_ || !frame->frame_) return nullptr;
+
+		// rs2_process_frame will release the input frame, so we need to addref
+		CallNativeFunc(rs2_frame_add_ref, &this->error_, frame->frame_, &this->error_);
+		if (this->error_) return nullptr;
+
+		CallNativeFunc(rs2_process_frame, &this->error_, this->block_, frame->frame_, &this->error_);
+		if (this->error_) return nullptr;
+
+		rs2_frame* result = nullptr;
+		GetNativeResult<int>(rs2_poll_for_frame, &this->error_, this->frame_queue_, &result, &this->error_);
+		return result;
+	}
+
+	/**
+	 * info[0] -> The depth RSFrame
+	 * info[1] -> Optional Float32Array receiving x, y, z for every point
+	 * info[2] -> Optional Float32Array receiving u, v for every point
+	 *
+	 * With output arrays, the point count is returned once both are filled, or -1 when either is too
+	 * small. Without them, the points RSFrame is returned, whose getVertices() and
+	 * getTextureCoordinates() are views over the librealsense memory.
+	 */
+	Napi::Value Calculate(const CallbackInfo& info) {
+		auto depth = info[0].IsObject() ? ObjectWrap<RSFrame>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!this->block_ || !depth || !depth->frame_) return info.Env().Undefined();
+
+		auto with_output = info[1].IsTypedArray();
+		if (with_output && !ExpectTypedArray(info[1], napi_float32_array, "Float32Array for the vertices"))
+			return info.Env().Undefined();
+		if (with_output && info[2].IsTypedArray()
+			&& !ExpectTypedArray(info[2], napi_float32_array, "Float32Array for the texture coordinates"))
+			return info.Env().Undefined();
+
+		auto points = this->ProcessFrame(depth);
+		if (!points) return info.Env().Undefined();
+		if (!with_output) return RSFrame::NewInstance(info.Env(), points);
+
+		auto count		= GetNativeResult<int>(rs2_get_frame_points_count, &this->error_, points, &this->error_);
+		auto vertices	= GetNativeResult<rs2_vertex*>(rs2_get_frame_vertices, &this->error_, points, &this->error_);
+		auto vertex_out = info[1].As<Float32Array>();
+		auto written	= vertices && vertex_out.ElementLength() >= 3 * static_cast<size_t>(count);
+		if (written) memcpy(vertex_out.Data(), vertices, 3 * count * sizeof(float));
+
+		if (written && info[2].IsTypedArray()) {
+			auto coords = GetNativeResult<
+			  rs2_pixel*>(rs2_get_frame_texture_coordinates, &this->error_, points, &this->error_);
+			auto coord_out = info[2].As<Float32Array>();
+			written		   = coords && coord_out.ElementLength() >= 2 * static_cast<size_t>(count);
+			// The block stores float (u, v) pairs in the rs2_pixel slots.
+			if (written) memcpy(coord_out.Data(), coords, 2 * count * sizeof(float));
+		}
+
+		rs2_release_frame(points);
+		return Number::New(info.Env(), written ? count : -1);
+	}
+
+	/**
+	 * info[0] -> The RSFrame whose stream provides the texture coordinates
+	 *
+	 * Same as librealsense's pointcloud::map_to, the stream filter options select the texture stream and
+	 * the frame is processed once, so that the block keeps it as its current texture.
+	 */
+	Napi::Value MapTo(const CallbackInfo& info) {
+		auto texture = info[0].IsObject() ? ObjectWrap<RSFrame>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!this->block_ || !texture || !texture->frame_) return info.This();
+
+		auto profile = GetNativeResult<
+		  const rs2_stream_profile*>(rs2_get_frame_stream_profile, &this->error_, texture->frame_, &this->error_);
+		if (!profile) return info.This();
+
+		rs2_stream stream = RS2_STREAM_ANY;
+		rs2_format format = RS2_FORMAT_ANY;
+		int index		  = 0;
+		int unique_id	  = 0;
+		int fps			  = 0;
+		CallNativeFunc(
+		  rs2_get_stream_profile_data,
+		  &this->error_,
+		  profile,
+		  &stream,
+		  &format,
+		  &index,
+		  &unique_id,
+		  &fps,
+		  &this->error_);
+		if (this->error_) return info.This();
+
+		auto options = this->GetOptionsPointer();
+		CallNativeFunc(rs2_set_option, &this->error_, options, RS2_OPTION_STREAM_FILTER, float(stream), &this->error_);
+		CallNativeFunc(
+		  rs2_set_option, &this->error_, options, RS2_OPTION_STREAM_FORMAT_FILTER, float(format), &this->error_);
+		CallNativeFunc(
+		  rs2_set_option, &this->error_, options, RS2_OPTION_STREAM_INDEX_FILTER, float(index), &this->error_);
+
+		// Processing a texture frame produces no points; anything that does come out is discarded.
+		auto result = this->ProcessFrame(texture);
+		if (result) rs2_release_frame(result);
+
+		return info.This();
+	}
+
+	Napi::Value SupportsOption(const CallbackInfo& info) {
+		return this->SupportsOptionInternal(info);
+	}
+
+	Napi::Value GetAllOptions(const CallbackInfo& info) {
+		return this->GetAllOptionsInternal(info);
+	}
+
+	Napi::Value ApplyOptions(const CallbackInfo& info) {
+		return this->ApplyOptionsInternal(info);
+	}
+
+	Napi::Value GetOption(const CallbackInfo& info) {
+		return this->GetOptionInternal(info);
+	}
+
+	Napi::Value GetOptionDescription(const CallbackInfo& info) {
+		return this->GetOptionDescriptionInternal(info);
+	}
+
+	Napi::Value GetOptionValueDescription(const CallbackInfo& info) {
+		return this->GetOptionValueDescriptionInternal(info);
+	}
+
+	Napi::Value SetOption(const CallbackInfo& info) {
+		return this->SetOptionInternal(info);
+	}
+
+	Napi::Value GetOptionRange(const CallbackInfo& info) {
+		return this->GetOptionRangeInternal(info);
+	}
+
+	Napi::Value IsOptionReadonly(const CallbackInfo& info) {
+		return this->IsOptionReadonlyInternal(info);
+	}
+};
+
+#endif
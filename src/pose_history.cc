@@ -0,0 +1,290 @@
+#ifndef POSE_HISTORY_H
+#define POSE_HISTORY_H
+
+#include "addon_data.cc"
+#include "frame.cc"
+#include "frameset.cc"
+#include "utils.cc"
+#include <algorithm>
+#include <cmath>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <mutex>
+#include <napi.h>
+#include <vector>
+
+using namespace Napi;
+
+/**
+ * A fixed-capacity, time-ordered ring of poses, written from a librealsense callback thread or from JS,
+ * and sampled at arbitrary timestamps. Samples in between two poses are interpolated: linearly for the
+ * vectors, by slerp for the rotation.
+ */
+class PoseRing {
+  public:
+	explicit PoseRing(uint32_t capacity)
+	  : timestamps_(capacity ? capacity : 1)
+	  , poses_(capacity ? capacity : 1)
+	  , head_(0)
+	  , size_(0) {
+	}
+
+	// Samples older than the newest one are dropped, so the ring always stays sorted.
+	bool Push(double timestamp, const rs2_pose& pose) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (size_ && timestamp <= timestamps_[Index(size_ - 1)]) return false;
+
+		if (size_ == timestamps_.size()) {
+			head_ = (head_ + 1) % timestamps_.size();
+			size_--;
+		}
+		timestamps_[Index(size_)] = timestamp;
+		poses_[Index(size_)]	  = pose;
+		size_++;
+
+		return true;
+	}
+
+	// Pose frames are pushed as they come, and so are the pose frames found in a frameset.
+	void PushFrame(rs2_frame* frame) {
+		rs2_error* error = nullptr;
+		if (rs2_is_frame_extendable_to(frame, RS2_EXTENSION_COMPOSITE_FRAME, &error) && !error) {
+			auto count = rs2_embedded_frames_count(frame, &error);
+			for (int i = 0; i < count && !error; i++) {
+				auto embedded = rs2_extract_frame(frame, i, &error);
+				if (!embedded) continue;
+
+				PushFrame(embedded);
+				rs2_release_frame(embedded);
+			}
+		}
+		else if (!error && rs2_is_frame_extendable_to(frame, RS2_EXTENSION_POSE_FRAME, &error) && !error) {
+			rs2_pose pose;
+			auto timestamp = rs2_get_frame_timestamp(frame, &error);
+			if (!error) rs2_pose_frame_get_pose_data(frame, &pose, &error);
+			if (!error) Push(timestamp, pose);
+		}
+
+		if (error) rs2_free_error(error);
+	}
+
+	bool PoseAt(double timestamp, rs2_pose* pose) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!size_ || timestamp < timestamps_[Index(0)] || timestamp > timestamps_[Index(size_ - 1)]) return false;
+
+		// Binary search for the first sample at or after the timestamp.
+		size_t lo = 0, hi = size_ - 1;
+		while (lo < hi) {
+			size_t mid = (lo + hi) / 2;
+			if (timestamps_[Index(mid)] < timestamp)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (timestamps_[Index(lo)] == timestamp || !lo) {
+			*pose = poses_[Index(lo)];
+			return true;
+		}
+
+		auto t0 = timestamps_[Index(lo - 1)];
+		auto t1 = timestamps_[Index(lo)];
+		Interpolate(poses_[Index(lo - 1)], poses_[Index(lo)], static_cast<float>((timestamp - t0) / (t1 - t0)), pose);
+		return true;
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		head_ = 0;
+		size_ = 0;
+	}
+
+	uint32_t Size() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return size_;
+	}
+
+	// Oldest and newest timestamps, both 0 while the ring is empty.
+	void Range(double* oldest, double* newest) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		*oldest = size_ ? timestamps_[Index(0)] : 0;
+		*newest = size_ ? timestamps_[Index(size_ - 1)] : 0;
+	}
+
+  private:
+	size_t Index(size_t i) const {
+		return (head_ + i) % timestamps_.size();
+	}
+
+	static rs2_vector Lerp(const rs2_vector& a, const rs2_vector& b, float t) {
+		return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+	}
+
+	static rs2_quaternion Slerp(const rs2_quaternion& a, rs2_quaternion b, float t) {
+		float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+		// q and -q are the same rotation, take the short way around.
+		if (dot < 0) {
+			b	= { -b.x, -b.y, -b.z, -b.w };
+			dot = -dot;
+		}
+
+		float wa = 1 - t, wb = t;
+		// Nearly parallel quaternions are lerped, which avoids dividing by a vanishing sine.
+		if (dot < 0.9995f) {
+			float theta = std::acos(dot);
+			float sine	= std::sin(theta);
+			wa			= std::sin((1 - t) * theta) / sine;
+			wb			= std::sin(t * theta) / sine;
+		}
+
+		rs2_quaternion q = { wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z, wa * a.w + wb * b.w };
+		float norm		 = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		return { q.x / norm, q.y / norm, q.z / norm, q.w / norm };
+	}
+
+	static void Interpolate(const rs2_pose& a, const rs2_pose& b, float t, rs2_pose* out) {
+		out->translation		  = Lerp(a.translation, b.translation, t);
+		out->velocity			  = Lerp(a.velocity, b.velocity, t);
+		out->acceleration		  = Lerp(a.acceleration, b.acceleration, t);
+		out->rotation			  = Slerp(a.rotation, b.rotation, t);
+		out->angular_velocity	  = Lerp(a.angular_velocity, b.angular_velocity, t);
+		out->angular_acceleration = Lerp(a.angular_acceleration, b.angular_acceleration, t);
+		// An interpolated pose is only as trustworthy as the weaker of its two samples.
+		out->tracker_confidence = std::min(a.tracker_confidence, b.tracker_confidence);
+		out->mapper_confidence	= std::min(a.mapper_confidence, b.mapper_confidence);
+	}
+
+	std::vector<double> timestamps_;
+	std::vector<rs2_pose> poses_;
+	size_t head_;
+	size_t size_;
+	std::mutex mutex_;
+};
+
+class FrameCallbackForPoseRing : public rs2_frame_callback {
+  public:
+	explicit FrameCallbackForPoseRing(std::shared_ptr<PoseRing> ring)
+	  : ring_(ring) {
+	}
+	void on_frame(rs2_frame* frame) override {
+		ring_->PushFrame(frame);
+		rs2_release_frame(frame);
+	}
+	void release() override {
+		delete this;
+	}
+	std::shared_ptr<PoseRing> ring_;
+};
+
+class RSPoseHistory : public ObjectWrap<RSPoseHistory> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSPoseHistory",
+		  {
+			InstanceMethod("clear", &RSPoseHistory::Clear),
+			InstanceMethod("destroy", &RSPoseHistory::Destroy),
+			InstanceMethod("getRange", &RSPoseHistory::GetRange),
+			InstanceMethod("getSize", &RSPoseHistory::GetSize),
+			InstanceMethod("poseAt", &RSPoseHistory::PoseAt),
+			InstanceMethod("push", &RSPoseHistory::Push),
+			InstanceMethod("pushPose", &RSPoseHistory::PushPose),
+		  });
+
+		AddonData::SetConstructor<RSPoseHistory>(env, func);
+		exports.Set("RSPoseHistory", func);
+
+		return exports;
+	}
+
+	/**
+	 * info[0] -> Number of poses kept, default to 2 seconds of a 200 Hz pose stream
+	 */
+	RSPoseHistory(const CallbackInfo& info)
+	  : ObjectWrap<RSPoseHistory>(info)
+	  , ring_(std::make_shared<PoseRing>(info[0].IsNumber() ? info[0].ToNumber().Uint32Value() : 400)) {
+	}
+
+  private:
+	friend class RSSensor;
+
+	std::shared_ptr<PoseRing> ring_;
+
+	Napi::Value Clear(const CallbackInfo& info) {
+		this->ring_->Clear();
+		return info.This();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->ring_->Clear();
+		return info.This();
+	}
+
+	Napi::Value GetRange(const CallbackInfo& info) {
+		double oldest = 0, newest = 0;
+		this->ring_->Range(&oldest, &newest);
+
+		auto range = Array::New(info.Env(), 2);
+		range.Set(uint32_t(0), Number::New(info.Env(), oldest));
+		range.Set(uint32_t(1), Number::New(info.Env(), newest));
+		return range;
+	}
+
+	Napi::Value GetSize(const CallbackInfo& info) {
+		return Number::New(info.Env(), this->ring_->Size());
+	}
+
+	/**
+	 * info[0] -> Timestamp in milliseconds, in the same domain as the pose frames
+	 * info[1] -> Float32Array of at least RSPoseField.Count elements receiving the pose
+	 *
+	 * Returns false when the timestamp falls outside the poses held.
+	 */
+	Napi::Value PoseAt(const CallbackInfo& info) {
+		if (!ExpectTypedArray(info[1], napi_float32_array, "Float32Array for the pose"))
+			return info.Env().Undefined();
+		if (info[1].As<Float32Array>().ElementLength() < RSFrame::kPoseFieldCount)
+			return Boolean::New(info.Env(), false);
+
+		rs2_pose pose;
+		if (!this->ring_->PoseAt(info[0].ToNumber().DoubleValue(), &pose)) return Boolean::New(info.Env(), false);
+
+		RSFrame::WritePose(pose, info[1].As<Float32Array>().Data());
+		return Boolean::New(info.Env(), true);
+	}
+
+	/**
+	 * info[0] -> A pose RSFrame, or a frameset containing pose frames
+	 */
+	Napi::Value Push(const CallbackInfo& info) {
+		if (!info[0].IsObject()) return info.This();
+
+		// Unwrap only checks for a wrapped object, not for its class.
+		auto object		 = info[0].ToObject();
+		rs2_frame* frame = nullptr;
+		if (object.InstanceOf(AddonData::Constructor<RSFrameSet>(info.Env()).Value()))
+			frame = ObjectWrap<RSFrameSet>::Unwrap(object)->GetFrames();
+		else if (object.InstanceOf(AddonData::Constructor<RSFrame>(info.Env()).Value()))
+			frame = ObjectWrap<RSFrame>::Unwrap(object)->frame_;
+		if (frame) this->ring_->PushFrame(frame);
+
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> Timestamp in milliseconds
+	 * info[1] -> Float32Array with the RSPoseField layout
+	 */
+	Napi::Value PushPose(const CallbackInfo& info) {
+		if (!ExpectTypedArray(info[1], napi_float32_array, "Float32Array for the pose"))
+			return info.Env().Undefined();
+		if (info[1].As<Float32Array>().ElementLength() < RSFrame::kPoseFieldCount)
+			return Boolean::New(info.Env(), false);
+
+		rs2_pose pose;
+		RSFrame::ReadPose(info[1].As<Float32Array>().Data(), &pose);
+		return Boolean::New(info.Env(), this->ring_->Push(info[0].ToNumber().DoubleValue(), pose));
+	}
+};
+
+#endif
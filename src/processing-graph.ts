@@ -0,0 +1,69 @@
+import { addon, deleteAutomatically } from './addon';
+import { RSConfig, RSPipeline, RSProcessingGraph, RSProcessingStage, RSFrame, RSFrameSet } from './types';
+
+export class ProcessingGraph {
+  /**
+   * Construct a chain of processing blocks that runs on a native worker thread.
+   * Stages are applied in order, e.g.
+   *
+   * <pre><code>
+   *  new ProcessingGraph([
+   *    'decimation',
+   *    { type: 'spatial', options: { [RSOption.FilterMagnitude]: 3 } },
+   *    'temporal',
+   *    'hole-filling',
+   *    { type: 'align', stream: RSStreamType.Color },
+   *    'colorizer',
+   *  ])
+   * </code></pre>
+   * @param {RSProcessingStage[]} stages - the block names, or stage descriptions with options
+   */
+  private readonly cxxGraph: RSProcessingGraph;
+
+  constructor(
+    readonly stages: RSProcessingStage[]
+  ) {
+    this.cxxGraph = new addon.RSProcessingGraph();
+    if (!this.cxxGraph.create(stages)) throw new TypeError('Failed to create the processing graph');
+
+    deleteAutomatically(this);
+  }
+
+  /**
+   * Destroy the processing blocks, stopping the graph first if it is running
+   */
+  destroy() {
+    this.cxxGraph.destroy();
+  }
+
+  /**
+   * Start a pipeline that feeds this graph. Framesets never reach JS before the last stage;
+   * when the graph falls behind the device, stale input framesets are dropped.
+   * Prefer {@link Pipeline.startWithProcessingGraph}, which also stops the graph with the pipeline.
+   *
+   * @param {RSPipeline} pipeline - the native pipeline to start
+   * @param {Function} callback - called on the JS thread with the output of the last stage
+   * @param {RSConfig} [config] - stream configuration, e.g. playback from a .bag file
+   */
+  start(
+    pipeline: RSPipeline,
+    callback: (frames: RSFrameSet | RSFrame) => void,
+    config?: RSConfig
+  ) {
+    return this.cxxGraph.start(pipeline, callback, config);
+  }
+
+  /**
+   * Stop the pipeline feeding this graph, and wait for the worker thread to finish
+   */
+  stop() {
+    this.cxxGraph.stop();
+  }
+
+  /**
+   * Input and output queue counters, and the time spent in the last run of the chain
+   */
+  get stats() {
+    return this.cxxGraph.getStats();
+  }
+}
@@ -0,0 +1,34 @@
+#ifndef PROCESSING_BLOCKS_H
+#define PROCESSING_BLOCKS_H
+
+#include "utils.cc"
+#include <librealsense2/hpp/rs_types.hpp>
+#include <string>
+
+/**
+ * Creates a librealsense processing block from the names used on the JS side.
+ * `stream` is only read by "align", which aligns every frame to that stream.
+ * Returns nullptr for an unknown name, or with `error` set when librealsense fails.
+ */
+rs2_processing_block* CreateProcessingBlock(const std::string& type, rs2_stream stream, rs2_error** error) {
+	if (!type.compare("decimation"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_decimation_filter_block, error, error);
+	if (!type.compare("temporal"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_temporal_filter_block, error, error);
+	if (!type.compare("spatial"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_spatial_filter_block, error, error);
+	if (!type.compare("hole-filling"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_hole_filling_filter_block, error, error);
+	if (!type.compare("disparity-to-depth"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_disparity_transform_block, error, 0, error);
+	if (!type.compare("depth-to-disparity"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_disparity_transform_block, error, 1, error);
+	if (!type.compare("align")) return GetNativeResult<rs2_processing_block*>(rs2_create_align, error, stream, error);
+	if (!type.compare("colorizer")) return GetNativeResult<rs2_processing_block*>(rs2_create_colorizer, error, error);
+	if (!type.compare("pointcloud"))
+		return GetNativeResult<rs2_processing_block*>(rs2_create_pointcloud, error, error);
+
+	return nullptr;
+}
+
+#endif
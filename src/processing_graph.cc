@@ -0,0 +1,295 @@
+#ifndef PROCESSING_GRAPH_H
+#define PROCESSING_GRAPH_H
+
+#include "addon_data.cc"
+#include "config.cc"
+#include "dict_base.cc"
+#include "frame.cc"
+#include "frame_callbacks.cc"
+#include "frameset.cc"
+#include "pipeline.cc"
+#include "processing_blocks.cc"
+#include "utils.cc"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
+#include <mutex>
+#include <napi.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Napi;
+
+/**
+ * Runs a chain of processing blocks on a dedicated native thread, fed directly by a pipeline.
+ *
+ * The pipeline callback hands each frameset to a latest-only input queue, so a graph that falls behind
+ * drops stale input instead of building latency. The worker thread pushes a frameset through every
+ * block with a single rs2_process_frame call, since each block forwards its output straight into the
+ * next one, and only the result of the last block is queued for the JS thread.
+ */
+class RSProcessingGraph : public ObjectWrap<RSProcessingGraph> {
+  public:
+	static Object Init(Napi::Env env, Object exports) {
+		Napi::Function func = DefineClass(
+		  env,
+		  "RSProcessingGraph",
+		  {
+			InstanceMethod("create", &RSProcessingGraph::Create),
+			InstanceMethod("destroy", &RSProcessingGraph::Destroy),
+			InstanceMethod("getStats", &RSProcessingGraph::GetStats),
+			InstanceMethod("start", &RSProcessingGraph::Start),
+			InstanceMethod("stop", &RSProcessingGraph::Stop),
+		  });
+
+		AddonData::SetConstructor<RSProcessingGraph>(env, func);
+		exports.Set("RSProcessingGraph", func);
+
+		return exports;
+	}
+
+	RSProcessingGraph(const CallbackInfo& info)
+	  : ObjectWrap<RSProcessingGraph>(info)
+	  , error_(nullptr)
+	  , pipeline_(nullptr)
+	  , input_queue_(std::make_shared<BoundedFrameQueue>(BoundedFrameQueue::kLatestOnly, 1))
+	  , output_queue_(std::make_shared<BoundedFrameQueue>(BoundedFrameQueue::kLatestOnly, 1))
+	  , output_signal_(std::make_shared<JSThreadSignal>())
+	  , errors_to_(ErrorUtil::Current())
+	  , running_(false)
+	  , processed_(0)
+	  , errors_(0)
+	  , last_processing_ms_(0) {
+	}
+
+	~RSProcessingGraph() {
+		DestroyMe();
+	}
+
+  private:
+	rs2_error* error_;
+	std::vector<rs2_processing_block*> blocks_;
+	RSPipeline* pipeline_;
+	ObjectReference pipeline_ref_;
+	std::shared_ptr<BoundedFrameQueue> input_queue_;
+	std::shared_ptr<BoundedFrameQueue> output_queue_;
+	std::shared_ptr<JSThreadSignal> output_signal_;
+	std::shared_ptr<ErrorUtil> errors_to_;
+	std::thread worker_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> processed_;
+	std::atomic<uint64_t> errors_;
+	std::atomic<double> last_processing_ms_;
+	std::mutex last_error_mutex_;
+	std::string last_error_;
+
+	void Run() {
+		rs2_frame* frames = nullptr;
+		while (this->running_) {
+			if (!this->input_queue_->Pop(&frames, 100)) continue;
+
+			// Failures are counted for getStats() and forwarded to the error callback of the graph's env.
+			ErrorUtil::ForwardScope scope(this->errors_to_);
+			rs2_error* error = nullptr;
+			auto begin		 = std::chrono::steady_clock::now();
+			rs2_process_frame(this->blocks_.front(), frames, &error);
+			auto end = std::chrono::steady_clock::now();
+
+			this->last_processing_ms_ = std::chrono::duration<double, std::milli>(end - begin).count();
+			this->processed_++;
+			if (error) {
+				this->errors_++;
+				std::lock_guard<std::mutex> lock(this->last_error_mutex_);
+				this->last_error_ = rs2_get_error_message(error);
+				ErrorUtil::AnalyzeError(error);
+			}
+		}
+	}
+
+	// Runs on the JS thread whenever the last block has produced a result.
+	static void DeliverFrames(Napi::Env env, Function callback, void* context) {
+		auto graph		  = static_cast<RSProcessingGraph*>(context);
+		rs2_frame* frames = nullptr;
+		while (graph->output_queue_->TryPop(&frames)) {
+			HandleScope scope(env);
+			try {
+				callback.Call({ NewFrameOrFrameSet(env, frames) });
+			}
+			catch (const Error& e) {
+				e.ThrowAsJavaScriptException();
+				return;
+			}
+		}
+	}
+
+	void StopMe() {
+		if (!this->pipeline_) return;
+
+		// The pipeline callback thread must never be left blocked on a queue while the pipeline stops.
+		this->input_queue_->Close();
+		CallNativeFunc(rs2_pipeline_stop, &this->error_, this->pipeline_->pipeline_, &this->error_);
+
+		this->running_ = false;
+		if (this->worker_.joinable()) this->worker_.join();
+
+		this->output_queue_->Close();
+		this->output_signal_->Stop();
+		this->input_queue_->Clear();
+		this->output_queue_->Clear();
+
+		this->pipeline_ = nullptr;
+		this->pipeline_ref_.Reset();
+		this->Unref();
+	}
+
+	void DestroyMe() {
+		StopMe();
+		for (auto block : blocks_) rs2_delete_processing_block(block);
+		blocks_.clear();
+		error_ = nullptr;
+	}
+
+	/**
+	 * info[0] -> Array of stages, each one either a block name or
+	 *            { type: string, stream?: number, options?: { [option: number]: number } }
+	 */
+	Napi::Value Create(const CallbackInfo& info) {
+		if (!info[0].IsArray() || this->pipeline_) return info.Env().Undefined();
+
+		this->DestroyMe();
+		auto stages = info[0].As<Array>();
+		for (uint32_t i = 0; i < stages.Length(); i++) {
+			auto stage		 = stages.Get(i);
+			auto type		 = stage.IsString() ? stage.ToString().Utf8Value() : std::string();
+			rs2_stream align = RS2_STREAM_COLOR;
+			if (stage.IsObject()) {
+				auto spec = stage.ToObject();
+				type	  = spec.Get("type").ToString();
+				if (spec.Get("stream").IsNumber())
+					align = static_cast<rs2_stream>(spec.Get("stream").ToNumber().Int32Value());
+			}
+
+			auto block = CreateProcessingBlock(type, align, &this->error_);
+			if (!block) {
+				// A librealsense failure has already been reported through the error callback.
+				if (!this->error_)
+					TypeError::New(info.Env(), "Unknown processing stage: " + type).ThrowAsJavaScriptException();
+				this->DestroyMe();
+				return info.Env().Undefined();
+			}
+			this->blocks_.push_back(block);
+
+			if (!stage.IsObject() || !stage.ToObject().Get("options").IsObject()) continue;
+			auto options = stage.ToObject().Get("options").ToObject();
+			auto ids	 = options.GetPropertyNames();
+			for (uint32_t j = 0; j < ids.Length(); j++) {
+				auto id		= ids.Get(j).ToString();
+				auto key	= id.Utf8Value();
+				char* end	= nullptr;
+				auto option = std::strtol(key.c_str(), &end, 10);
+				// Keys are RSOption values; anything else would reach librealsense as a bogus option.
+				if (key.empty() || *end || option < 0 || option >= RS2_OPTION_COUNT) {
+					TypeError::New(info.Env(), "Unknown option for processing stage " + type + ": " + key)
+					  .ThrowAsJavaScriptException();
+					this->DestroyMe();
+					return info.Env().Undefined();
+				}
+
+				CallNativeFunc(
+				  rs2_set_option,
+				  &this->error_,
+				  reinterpret_cast<rs2_options*>(block),
+				  static_cast<rs2_option>(option),
+				  options.Get(id).ToNumber().FloatValue(),
+				  &this->error_);
+			}
+		}
+		if (this->blocks_.empty()) return info.Env().Undefined();
+
+		// Chain every block into the next one; the last one feeds the queue that JS drains.
+		for (size_t i = 0; i < this->blocks_.size(); i++) {
+			rs2_frame_callback* callback
+			  = i + 1 < this->blocks_.size()
+				  ? static_cast<rs2_frame_callback*>(new FrameCallbackForProcessingBlock(this->blocks_[i + 1]))
+				  : new FrameCallbackForBoundedQueue(this->output_queue_, this->output_signal_);
+			CallNativeFunc(rs2_start_processing, &this->error_, this->blocks_[i], callback, &this->error_);
+			if (this->error_) {
+				this->DestroyMe();
+				return info.Env().Undefined();
+			}
+		}
+
+		return info.This();
+	}
+
+	Napi::Value Destroy(const CallbackInfo& info) {
+		this->DestroyMe();
+		return info.This();
+	}
+
+	Napi::Value GetStats(const CallbackInfo& info) {
+		DictBase stats(info.Env());
+		stats.SetMember("input", RSFrameQueueStats(info.Env(), this->input_queue_->GetStats()).GetObject());
+		stats.SetMember("output", RSFrameQueueStats(info.Env(), this->output_queue_->GetStats()).GetObject());
+		stats.SetMemberT("processed", static_cast<double>(this->processed_));
+		stats.SetMemberT("errors", static_cast<double>(this->errors_));
+		stats.SetMemberT("lastProcessingMs", static_cast<double>(this->last_processing_ms_));
+
+		std::lock_guard<std::mutex> lock(this->last_error_mutex_);
+		if (!this->last_error_.empty()) stats.SetMember("lastError", this->last_error_);
+		return stats.GetObject();
+	}
+
+	/**
+	 * info[0] -> RSPipeline to stream from
+	 * info[1] -> The function called with the output of the last stage
+	 * info[2] -> Optional RSConfig
+	 */
+	Napi::Value Start(const CallbackInfo& info) {
+		if (this->blocks_.empty() || this->pipeline_ || !info[0].IsObject() || !info[1].IsFunction())
+			return info.Env().Undefined();
+
+		auto pipeline = ObjectWrap<RSPipeline>::Unwrap(info[0].ToObject());
+		if (!pipeline || !pipeline->pipeline_) return info.Env().Undefined();
+
+		this->input_queue_->Open();
+		this->output_queue_->Open();
+		this->output_signal_->Start(
+		  info.Env(), info[1].As<Function>(), "RSProcessingGraph::Start", DeliverFrames, this);
+
+		auto callback = new FrameCallbackForBoundedQueue(this->input_queue_, nullptr);
+		rs2_pipeline_profile* profile
+		  = !info[2].IsObject() ? GetNativeResult<rs2_pipeline_profile*>(
+			  rs2_pipeline_start_with_callback_cpp, &this->error_, pipeline->pipeline_, callback, &this->error_)
+								: GetNativeResult<rs2_pipeline_profile*>(
+								  rs2_pipeline_start_with_config_and_callback_cpp,
+								  &this->error_,
+								  pipeline->pipeline_,
+								  ObjectWrap<RSConfig>::Unwrap(info[2].ToObject())->config_,
+								  callback,
+								  &this->error_);
+		if (!profile) {
+			this->output_signal_->Stop();
+			return info.Env().Undefined();
+		}
+
+		// Both the graph and its pipeline stay alive while frames flow, even if JS drops every reference.
+		this->pipeline_		= pipeline;
+		this->pipeline_ref_ = Napi::Persistent(info[0].ToObject());
+		this->Ref();
+		this->running_ = true;
+		this->worker_  = std::thread(&RSProcessingGraph::Run, this);
+
+		return RSPipelineProfile::NewInstance(info.Env(), profile);
+	}
+
+	Napi::Value Stop(const CallbackInfo& info) {
+		this->StopMe();
+		return info.This();
+	}
+};
+
+#endif
@@ -1,15 +1,26 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include "addon_data.cc"
 #include "dicts.cc"
 #include "frame.cc"
+#include "frame_bus.cc"
+#include "frame_callbacks.cc"
+#include "frame_publisher.cc"
+#include "framequeue.cc"
+#include "imu_batcher.cc"
 #include "notification_callbacks.cc"
+#include "option_watcher.cc"
 #include "options.cc"
+#include "pose_history.cc"
 #include "syncer.cc"
 #include "utils.cc"
 #include <iostream>
 #include <librealsense2/hpp/rs_types.hpp>
+#include <memory>
 #include <napi.h>
+#include <utility>
+#include <vector>
 
 using namespace Napi;
 
@@ -24,8 +35,11 @@ class RSSensor
 		  {
 			InstanceAccessor("isDepthSensor", &RSSensor::IsDepthSensor, nullptr),
 			InstanceAccessor("isROISensor", &RSSensor::IsROISensor, nullptr),
+			InstanceMethod("applyOptions", &RSSensor::ApplyOptions),
 			InstanceMethod("close", &RSSensor::Close),
 			InstanceMethod("destroy", &RSSensor::Destroy),
+			InstanceMethod("findProfile", &RSSensor::FindProfile),
+			InstanceMethod("getAllOptions", &RSSensor::GetAllOptions),
 			InstanceMethod("getCameraInfo", &RSSensor::GetCameraInfo),
 			InstanceMethod("getDepthScale", &RSSensor::GetDepthScale),
 			InstanceMethod("getOption", &RSSensor::GetOption),
@@ -33,6 +47,8 @@ class RSSensor
 			InstanceMethod("getOptionRange", &RSSensor::GetOptionRange),
 			InstanceMethod("getOptionValueDescription", &RSSensor::GetOptionValueDescription),
 			InstanceMethod("getRegionOfInterest", &RSSensor::GetRegionOfInterest),
+			InstanceMethod("getStreamProfileAt", &RSSensor::GetStreamProfileAt),
+			InstanceMethod("getStreamProfileTable", &RSSensor::GetStreamProfileTable),
 			InstanceMethod("getStreamProfiles", &RSSensor::GetStreamProfiles),
 			InstanceMethod("isOptionReadonly", &RSSensor::IsOptionReadonly),
 			InstanceMethod("onNotification", &RSSensor::OnNotification),
@@ -41,14 +57,20 @@ class RSSensor
 			InstanceMethod("setOption", &RSSensor::SetOption),
 			InstanceMethod("setRegionOfInterest", &RSSensor::SetRegionOfInterest),
 			InstanceMethod("startWithCallback", &RSSensor::StartWithCallback),
+			InstanceMethod("startWithFrameBus", &RSSensor::StartWithFrameBus),
+			InstanceMethod("startWithFramePublisher", &RSSensor::StartWithFramePublisher),
+			InstanceMethod("startWithFrameQueue", &RSSensor::StartWithFrameQueue),
+			InstanceMethod("startWithImuBatcher", &RSSensor::StartWithImuBatcher),
+			InstanceMethod("startWithPoseHistory", &RSSensor::StartWithPoseHistory),
 			InstanceMethod("startWithSyncer", &RSSensor::StartWithSyncer),
 			InstanceMethod("stop", &RSSensor::Stop),
 			InstanceMethod("supportsCameraInfo", &RSSensor::SupportsCameraInfo),
 			InstanceMethod("supportsOption", &RSSensor::SupportsOption),
+			InstanceMethod("unwatchOptions", &RSSensor::UnwatchOptions),
+			InstanceMethod("watchOptions", &RSSensor::WatchOptions),
 		  });
 
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSSensor>(env, func);
 		exports.Set("RSSensor", func);
 
 		return exports;
@@ -56,7 +78,7 @@ class RSSensor
 
 	static Object NewInstance(Napi::Env env, rs2_sensor* sensor) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSSensor>(env).New({});
 
 		auto unwrapped	   = ObjectWrap<RSSensor>::Unwrap(instance);
 		unwrapped->sensor_ = sensor;
@@ -70,7 +92,7 @@ class RSSensor
 		return reinterpret_cast<rs2_options*>(sensor_);
 	}
 
-	void ReplaceFrame(rs2_frame* raw_frame) {
+	RSFrame* ReplaceFrame(rs2_frame* raw_frame) {
 		// clear old frame first.
 		frame_->Replace(nullptr);
 		video_frame_->Replace(nullptr);
@@ -79,29 +101,21 @@ class RSSensor
 		motion_frame_->Replace(nullptr);
 		pose_frame_->Replace(nullptr);
 
-		if (GetNativeResult<
-			  int>(rs2_is_frame_extendable_to, &error_, raw_frame, RS2_EXTENSION_DISPARITY_FRAME, &error_)) {
-			disparity_frame_->Replace(raw_frame);
-		}
-		else if (GetNativeResult<
-				   int>(rs2_is_frame_extendable_to, &error_, raw_frame, RS2_EXTENSION_DEPTH_FRAME, &error_)) {
-			depth_frame_->Replace(raw_frame);
-		}
-		else if (GetNativeResult<
-				   int>(rs2_is_frame_extendable_to, &error_, raw_frame, RS2_EXTENSION_VIDEO_FRAME, &error_)) {
-			video_frame_->Replace(raw_frame);
-		}
-		else if (GetNativeResult<
-				   int>(rs2_is_frame_extendable_to, &error_, raw_frame, RS2_EXTENSION_MOTION_FRAME, &error_)) {
-			motion_frame_->Replace(raw_frame);
-		}
-		else if (GetNativeResult<
-				   int>(rs2_is_frame_extendable_to, &error_, raw_frame, RS2_EXTENSION_POSE_FRAME, &error_)) {
-			pose_frame_->Replace(raw_frame);
-		}
-		else {
-			frame_->Replace(raw_frame);
-		}
+		auto type		= RSFrame::ClassifyFrame(raw_frame);
+		RSFrame* target = frame_;
+		if (type & RSFrame::kTypeDisparity)
+			target = disparity_frame_;
+		else if (type & RSFrame::kTypeDepth)
+			target = depth_frame_;
+		else if (type & RSFrame::kTypeVideo)
+			target = video_frame_;
+		else if (type & RSFrame::kTypeMotion)
+			target = motion_frame_;
+		else if (type & RSFrame::kTypePose)
+			target = pose_frame_;
+
+		target->Replace(raw_frame, type);
+		return target;
 	}
 	RSSensor(const CallbackInfo& info)
 	  : ObjectWrap<RSSensor>(info)
@@ -113,7 +127,8 @@ class RSSensor
 	  , depth_frame_(nullptr)
 	  , disparity_frame_(nullptr)
 	  , motion_frame_(nullptr)
-	  , pose_frame_(nullptr) {
+	  , pose_frame_(nullptr)
+	  , delivering_frames_(false) {
 	}
 
 	~RSSensor() {
@@ -121,10 +136,21 @@ class RSSensor
 	}
 
   private:
-  	static FunctionReference constructor;
+	// The fields of one stream profile, in the column order of getStreamProfileTable
+	struct ProfileRow {
+		int32_t stream;
+		int32_t format;
+		int32_t index;
+		int32_t unique_id;
+		int32_t fps;
+		int32_t width;
+		int32_t height;
+	};
+
 	rs2_sensor* sensor_;
 	rs2_error* error_;
 	rs2_stream_profile_list* profile_list_;
+	std::vector<ProfileRow> profile_table_;
 	std::string frame_callback_name_;
 	RSFrame* frame_;
 	RSFrame* video_frame_;
@@ -132,20 +158,63 @@ class RSSensor
 	RSFrame* disparity_frame_;
 	RSFrame* motion_frame_;
 	RSFrame* pose_frame_;
+	ObjectReference frame_refs_[6];
+	std::shared_ptr<BoundedFrameQueue> frame_queue_;
+	std::shared_ptr<JSThreadSignal> frame_signal_;
+	bool delivering_frames_;
+	std::unique_ptr<OptionWatcher> option_watcher_;
 	friend class RSContext;
-	friend class FrameCallbackInfo;
+
+	// Runs on the JS thread; frames that arrived since the last run were coalesced into the newest one.
+	static void DeliverFrame(Napi::Env env, Function callback, void* context) {
+		auto sensor = static_cast<RSSensor*>(context);
+		auto queue	= sensor->frame_queue_;
+		rs2_frame* raw_frame = nullptr;
+		if (!queue || !queue->TryPop(&raw_frame)) return;
+
+		HandleScope scope(env);
+		auto target = sensor->ReplaceFrame(raw_frame);
+		try {
+			callback.Call({ target->Value() });
+		}
+		catch (const Error& e) {
+			e.ThrowAsJavaScriptException();
+		}
+	}
+
+	void StopFrameDelivery() {
+		if (this->frame_signal_) this->frame_signal_->Stop();
+		if (this->frame_queue_) this->frame_queue_->Clear();
+		this->frame_signal_ = nullptr;
+		this->frame_queue_	= nullptr;
+
+		if (this->delivering_frames_) this->Unref();
+		this->delivering_frames_ = false;
+	}
 
     void RegisterNotificationCallbackMethod(std::shared_ptr<ThreadSafeCallback> callback) {
-        rs2_set_notifications_callback_cpp(sensor_, new NotificationCallback(callback), &this->error_);
+        CallNativeFunc(
+          rs2_set_notifications_callback_cpp, &this->error_, sensor_, new NotificationCallback(callback), &this->error_);
     }
 
+	void StopOptionWatcher() {
+		if (!this->option_watcher_) return;
+
+		this->option_watcher_ = nullptr;
+		this->Unref();
+	}
+
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
+		// The watcher thread reads options through sensor_, so it stops first.
+		StopOptionWatcher();
+		if (frame_queue_) frame_queue_->Close();
 		error_ = nullptr;
 		if (sensor_) rs2_delete_sensor(sensor_);
 		sensor_ = nullptr;
+		StopFrameDelivery();
 		if (profile_list_) rs2_delete_stream_profiles_list(profile_list_);
 		profile_list_ = nullptr;
+		profile_table_.clear();
 	}
 
 	Napi::Value Close(const CallbackInfo& info) {
@@ -202,20 +271,134 @@ class RSSensor
 		return RSRegionOfInterest(info.Env(), minx, miny, maxx, maxy).GetObject();
 	}
 
-	Napi::Value GetStreamProfiles(const CallbackInfo& info) {
-		rs2_stream_profile_list* list = this->profile_list_;
-		if (!list) {
-			list = GetNativeResult<
+	rs2_stream_profile_list* GetProfileList() {
+		if (!this->profile_list_) {
+			this->profile_list_ = GetNativeResult<
 			  rs2_stream_profile_list*>(rs2_get_stream_profiles, &this->error_, this->sensor_, &this->error_);
-			this->profile_list_ = list;
 		}
+		return this->profile_list_;
+	}
+
+	// Reads every profile once, without creating any JS object; rows follow the profile list order.
+	const std::vector<ProfileRow>* GetProfileTable() {
+		auto list = this->GetProfileList();
+		if (!list) return nullptr;
+		if (!this->profile_table_.empty()) return &this->profile_table_;
+
+		int32_t size = GetNativeResult<int>(rs2_get_stream_profiles_count, &this->error_, list, &this->error_);
+		this->profile_table_.reserve(size);
+		for (int32_t i = 0; i < size; i++) {
+			ProfileRow row	  = {};
+			rs2_stream stream = RS2_STREAM_ANY;
+			rs2_format format = RS2_FORMAT_ANY;
+			rs2_error* error  = nullptr;
+			auto profile	  = rs2_get_stream_profile(list, i, &error);
+			if (!error)
+				rs2_get_stream_profile_data(profile, &stream, &format, &row.index, &row.unique_id, &row.fps, &error);
+			if (!error && rs2_stream_profile_is(profile, RS2_EXTENSION_VIDEO_PROFILE, &error) && !error)
+				rs2_get_video_stream_resolution(profile, &row.width, &row.height, &error);
+			if (error) rs2_free_error(error);
+
+			row.stream = stream;
+			row.format = format;
+			this->profile_table_.push_back(row);
+		}
+		return &this->profile_table_;
+	}
+
+	/**
+	 * info[0] -> { stream, format, width, height, fps, index }, where missing or zero fields match anything
+	 *
+	 * Returns the first matching RSStreamProfile, or undefined.
+	 */
+	Napi::Value FindProfile(const CallbackInfo& info) {
+		auto table = this->GetProfileTable();
+		if (!table || !info[0].IsObject()) return info.Env().Undefined();
+
+		auto query = info[0].ToObject();
+		auto field = [&query](const char* name) {
+			return query.Has(name) && query.Get(name).IsNumber() ? query.Get(name).ToNumber().Int32Value() : 0;
+		};
+		ProfileRow wanted = {};
+		wanted.stream	  = field("stream");
+		wanted.format	  = field("format");
+		wanted.index	  = field("index");
+		wanted.fps		  = field("fps");
+		wanted.width	  = field("width");
+		wanted.height	  = field("height");
+		auto matches = [](int32_t value, int32_t wanted) { return !wanted || value == wanted; };
+
+		for (size_t i = 0; i < table->size(); i++) {
+			const auto& row = (*table)[i];
+			if (
+			  matches(row.stream, wanted.stream) && matches(row.format, wanted.format)
+			  && matches(row.index, wanted.index) && matches(row.fps, wanted.fps) && matches(row.width, wanted.width)
+			  && matches(row.height, wanted.height)) {
+				auto profile = const_cast<rs2_stream_profile*>(GetNativeResult<const rs2_stream_profile*>(
+				  rs2_get_stream_profile, &this->error_, this->profile_list_, static_cast<int>(i), &this->error_));
+				if (!profile) return info.Env().Undefined();
+
+				return RSStreamProfile::NewInstance(info.Env(), profile);
+			}
+		}
+		return info.Env().Undefined();
+	}
+
+	/**
+	 * info[0] -> Row of the profile in getStreamProfileTable
+	 */
+	Napi::Value GetStreamProfileAt(const CallbackInfo& info) {
+		auto table = this->GetProfileTable();
+		auto row   = info[0].ToNumber().Int32Value();
+		if (!table || row < 0 || static_cast<size_t>(row) >= table->size()) return info.Env().Undefined();
+
+		auto profile = const_cast<rs2_stream_profile*>(GetNativeResult<
+		  const rs2_stream_profile*>(rs2_get_stream_profile, &this->error_, this->profile_list_, row, &this->error_));
+		if (!profile) return info.Env().Undefined();
+
+		return RSStreamProfile::NewInstance(info.Env(), profile);
+	}
+
+	/**
+	 * Returns { count, stream, format, index, uniqueId, fps, width, height }, one Int32Array per field with a
+	 * row per profile; width and height are 0 for non-video profiles.
+	 */
+	Napi::Value GetStreamProfileTable(const CallbackInfo& info) {
+		auto table = this->GetProfileTable();
+		if (!table) return info.Env().Undefined();
+
+		static const std::pair<const char*, int32_t ProfileRow::*> kColumns[] = {
+			{ "stream", &ProfileRow::stream }, { "format", &ProfileRow::format },
+			{ "index", &ProfileRow::index },   { "uniqueId", &ProfileRow::unique_id },
+			{ "fps", &ProfileRow::fps },	   { "width", &ProfileRow::width },
+			{ "height", &ProfileRow::height },
+		};
+		auto count	= table->size();
+		auto result = Object::New(info.Env());
+		result.Set("count", Number::New(info.Env(), count));
+
+		// All columns share one buffer.
+		auto buffer = ArrayBuffer::New(info.Env(), sizeof(kColumns) / sizeof(kColumns[0]) * count * sizeof(int32_t));
+		auto offset = size_t(0);
+		for (const auto& column : kColumns) {
+			auto data = reinterpret_cast<int32_t*>(static_cast<uint8_t*>(buffer.Data()) + offset);
+			for (size_t r = 0; r < count; r++) data[r] = (*table)[r].*column.second;
+
+			result.Set(column.first, Int32Array::New(info.Env(), count, buffer, offset));
+			offset += count * sizeof(int32_t);
+		}
+		return result;
+	}
+
+	Napi::Value GetStreamProfiles(const CallbackInfo& info) {
+		rs2_stream_profile_list* list = this->GetProfileList();
 		if (!list) return info.Env().Undefined();
 
 		int32_t size = GetNativeResult<int>(rs2_get_stream_profiles_count, &this->error_, list, &this->error_);
 		auto array	 = Array::New(info.Env());
 		for (int32_t i = 0; i < size; i++) {
-			rs2_stream_profile* profile
-			  = const_cast<rs2_stream_profile*>(rs2_get_stream_profile(list, i, &this->error_));
+			rs2_stream_profile* profile = const_cast<rs2_stream_profile*>(
+			  GetNativeResult<const rs2_stream_profile*>(rs2_get_stream_profile, &this->error_, list, i, &this->error_));
 			array.Set(i, RSStreamProfile::NewInstance(info.Env(), profile));
 		}
 
@@ -285,25 +468,117 @@ class RSSensor
 		return info.This();
 	}
 
+	/**
+	 * info[0] -> The function called with each frame
+	 * info[1..6] -> The RSFrame wrappers reused for generic, depth, video, disparity, motion and pose frames
+	 */
 	Napi::Value StartWithCallback(const CallbackInfo& info) {
-        auto callback = std::make_shared<ThreadSafeCallback>(info[0].As<Function>());
-		auto frame			 = ObjectWrap<RSFrame>::Unwrap(info[1].ToObject());
-		auto depth_frame	 = ObjectWrap<RSFrame>::Unwrap(info[2].ToObject());
-		auto video_frame	 = ObjectWrap<RSFrame>::Unwrap(info[3].ToObject());
-		auto disparity_frame = ObjectWrap<RSFrame>::Unwrap(info[4].ToObject());
-		auto motion_frame	 = ObjectWrap<RSFrame>::Unwrap(info[5].ToObject());
-		auto pose_frame		 = ObjectWrap<RSFrame>::Unwrap(info[6].ToObject());
-		if (frame && depth_frame && video_frame && disparity_frame && motion_frame && pose_frame) {
-			this->frame_			   = frame;
-			this->depth_frame_		   = depth_frame;
-			this->video_frame_		   = video_frame;
-			this->disparity_frame_	   = disparity_frame;
-			this->motion_frame_		   = motion_frame;
-			this->pose_frame_		   = pose_frame;
-			// this->frame_callback_name_ = std::string(info[0].ToString());
-			CallNativeFunc(rs2_start_cpp, &this->error_, this->sensor_, new FrameCallbackForProc(callback, this), &this->error_);
+		if (!info[0].IsFunction()) return info.Env().Undefined();
+
+		RSFrame* frames[6];
+		for (uint32_t i = 0; i < 6; i++) {
+			frames[i] = info[i + 1].IsObject() ? ObjectWrap<RSFrame>::Unwrap(info[i + 1].ToObject()) : nullptr;
+			if (!frames[i]) return info.Env().Undefined();
 		}
-		return info.Env().Undefined();
+
+		this->StopFrameDelivery();
+		this->frame_		   = frames[0];
+		this->depth_frame_	   = frames[1];
+		this->video_frame_	   = frames[2];
+		this->disparity_frame_ = frames[3];
+		this->motion_frame_	   = frames[4];
+		this->pose_frame_	   = frames[5];
+		for (uint32_t i = 0; i < 6; i++) this->frame_refs_[i] = Napi::Persistent(info[i + 1].ToObject());
+
+		this->frame_queue_	= std::make_shared<BoundedFrameQueue>(BoundedFrameQueue::kLatestOnly, 1);
+		this->frame_signal_ = std::make_shared<JSThreadSignal>();
+		this->frame_signal_->Start(
+		  info.Env(), info[0].As<Function>(), "RSSensor::StartWithCallback", DeliverFrame, this);
+
+		CallNativeFunc(
+		  rs2_start_cpp,
+		  &this->error_,
+		  this->sensor_,
+		  new FrameCallbackForBoundedQueue(this->frame_queue_, this->frame_signal_),
+		  &this->error_);
+		if (this->error_) {
+			this->StopFrameDelivery();
+			return info.This();
+		}
+
+		// Streaming keeps the sensor alive until stop() or destroy(), even if JS drops every reference.
+		this->Ref();
+		this->delivering_frames_ = true;
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> RSFrameQueue receiving every frame; several sensors may share one queue
+	 */
+	Napi::Value StartWithFrameQueue(const CallbackInfo& info) {
+		auto queue = info[0].IsObject() ? ObjectWrap<RSFrameQueue>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!queue || !queue->queue_) return info.Env().Undefined();
+
+		CallNativeFunc(
+		  rs2_start_cpp,
+		  &this->error_,
+		  this->sensor_,
+		  new FrameCallbackForBoundedQueue(queue->queue_, nullptr),
+		  &this->error_);
+
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> RSFrameBus publishing every frame of its streams to other processes, without involving JS
+	 */
+	Napi::Value StartWithFrameBus(const CallbackInfo& info) {
+		auto bus = info[0].IsObject() ? ObjectWrap<RSFrameBus>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!bus || !bus->ring_) return info.Env().Undefined();
+
+		CallNativeFunc(
+		  rs2_start_cpp, &this->error_, this->sensor_, new FrameCallbackForFrameRing(bus->ring_), &this->error_);
+
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> RSFramePublisher writing every frame of its streams into its ring, without involving JS
+	 */
+	Napi::Value StartWithFramePublisher(const CallbackInfo& info) {
+		auto publisher = info[0].IsObject() ? ObjectWrap<RSFramePublisher>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!publisher || !publisher->ring_) return info.Env().Undefined();
+
+		CallNativeFunc(
+		  rs2_start_cpp, &this->error_, this->sensor_, new FrameCallbackForFrameRing(publisher->ring_), &this->error_);
+
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> RSImuBatcher collecting every motion sample the sensor produces, JS is only woken per batch
+	 */
+	Napi::Value StartWithImuBatcher(const CallbackInfo& info) {
+		auto batcher = info[0].IsObject() ? ObjectWrap<RSImuBatcher>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!batcher || !batcher->collector_) return info.Env().Undefined();
+
+		CallNativeFunc(
+		  rs2_start_cpp, &this->error_, this->sensor_, new FrameCallbackForImuCollector(batcher->collector_), &this->error_);
+
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> RSPoseHistory recording every pose the sensor produces, without involving JS
+	 */
+	Napi::Value StartWithPoseHistory(const CallbackInfo& info) {
+		auto history = info[0].IsObject() ? ObjectWrap<RSPoseHistory>::Unwrap(info[0].ToObject()) : nullptr;
+		if (!history) return info.Env().Undefined();
+
+		CallNativeFunc(
+		  rs2_start_cpp, &this->error_, this->sensor_, new FrameCallbackForPoseRing(history->ring_), &this->error_);
+
+		return info.This();
 	}
 
 	Napi::Value StartWithSyncer(const CallbackInfo& info) {
@@ -321,7 +596,9 @@ class RSSensor
 	}
 
 	Napi::Value Stop(const CallbackInfo& info) {
+		if (this->frame_queue_) this->frame_queue_->Close();
 		CallNativeFunc(rs2_stop, &this->error_, this->sensor_, &this->error_);
+		this->StopFrameDelivery();
 		return info.This();
 	}
 
@@ -336,8 +613,55 @@ class RSSensor
 	Napi::Value SupportsOption(const CallbackInfo& info) {
 		return this->SupportsOptionInternal(info);
 	}
-};
 
-Napi::FunctionReference RSSensor::constructor;
+	Napi::Value GetAllOptions(const CallbackInfo& info) {
+		return this->GetAllOptionsInternal(info);
+	}
+
+	Napi::Value ApplyOptions(const CallbackInfo& info) {
+		return this->ApplyOptionsInternal(info);
+	}
+
+	Napi::Value UnwatchOptions(const CallbackInfo& info) {
+		this->StopOptionWatcher();
+		return info.This();
+	}
+
+	/**
+	 * info[0] -> Int32Array or array of the option ids to watch
+	 * info[1] -> Polling interval in milliseconds, at least 10, default to 100
+	 * info[2] -> The function called with (ids: Int32Array, values: Float32Array) holding the options that
+	 *            changed since the last call
+	 *
+	 * Replaces any previous watcher. The sensor stays alive until unwatchOptions() or destroy().
+	 */
+	Napi::Value WatchOptions(const CallbackInfo& info) {
+		if (!this->sensor_ || !info[0].IsObject() || !info[2].IsFunction()) return info.Env().Undefined();
+
+		auto interval_ms = info[1].IsNumber() ? info[1].ToNumber().Uint32Value() : OptionWatcher::kDefaultIntervalMs;
+		if (interval_ms < OptionWatcher::kMinIntervalMs) {
+			RangeError::New(info.Env(), "Option polling interval must be at least 10 ms").ThrowAsJavaScriptException();
+			return info.Env().Undefined();
+		}
+
+		std::vector<rs2_option> watched;
+		auto ids	= info[0].ToObject();
+		auto length = info[0].IsTypedArray() ? info[0].As<TypedArray>().ElementLength()
+											 : ids.Get("length").ToNumber().Uint32Value();
+		for (uint32_t i = 0; i < length; i++) {
+			auto id = ids.Get(i).ToNumber().Int32Value();
+			if (id >= 0 && id < RS2_OPTION_COUNT) watched.push_back(static_cast<rs2_option>(id));
+		}
+
+		this->StopOptionWatcher();
+		std::unique_ptr<OptionWatcher> watcher(
+		  new OptionWatcher(this->GetOptionsPointer(), watched, interval_ms));
+		if (!watcher->Start(info.Env(), info[2].As<Function>())) return info.Env().Undefined();
+
+		this->option_watcher_ = std::move(watcher);
+		this->Ref();
+		return info.This();
+	}
+};
 
 #endif
@@ -1,13 +1,16 @@
 #ifndef STREAM_PROFILE_H
 #define STREAM_PROFILE_H
 
+#include "addon_data.cc"
 #include "dicts.cc"
 #include "utils.cc"
 #include <iostream>
 #include <librealsense2/h/rs_internal.h>
 #include <librealsense2/hpp/rs_types.hpp>
 #include <librealsense2/rs.h>
+#include <memory>
 #include <napi.h>
+#include <unordered_map>
 
 using namespace Napi;
 
@@ -33,8 +36,7 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 			InstanceMethod("getMotionIntrinsics", &RSStreamProfile::GetMotionIntrinsics),
 			InstanceMethod("getVideoStreamIntrinsics", &RSStreamProfile::GetVideoStreamIntrinsics),
 		  });
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSStreamProfile>(env, func);
 		exports.Set("RSStreamProfile", func);
 
 		return exports;
@@ -42,7 +44,7 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 
 	static Object NewInstance(Napi::Env env, rs2_stream_profile* p, bool own = false) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSStreamProfile>(env).New({});
 
 		auto unwrapped			= ObjectWrap<RSStreamProfile>::Unwrap(instance);
 		unwrapped->profile_		= p;
@@ -58,26 +60,64 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 		  &unwrapped->fps_,
 		  &unwrapped->error_);
 
-		unwrapped->is_default_ = rs2_is_stream_profile_default(p, &unwrapped->error_);
+		// Borrowed profiles may be freed along with their list, so everything is read while they are alive.
+		if (!own) unwrapped->LoadDetails();
 
-		if (GetNativeResult<
-			  bool>(rs2_stream_profile_is, &unwrapped->error_, p, RS2_EXTENSION_VIDEO_PROFILE, &unwrapped->error_)) {
-			unwrapped->is_video_ = true;
-			CallNativeFunc(
-			  rs2_get_video_stream_resolution,
-			  &unwrapped->error_,
-			  p,
-			  &unwrapped->width_,
-			  &unwrapped->height_,
-			  &unwrapped->error_);
+		return scope.Escape(napi_value(instance)).ToObject();
+	}
+
+	/**
+	 * Returns the RSStreamProfile already handed out for the profile's unique id, or wraps a clone of the
+	 * profile and remembers it. Interned profiles are only weakly held, so they go away with their last JS
+	 * reference, and read their remaining fields, intrinsics and extrinsics on first use.
+	 *
+	 * The registry is kept per addon environment rather than per RSContext: frames carry no reference to the
+	 * context their device came from, so ids are shared by all contexts of a worker. A hit is only taken
+	 * when stream, format, index and fps match too, which keeps colliding ids of different contexts or
+	 * playbacks apart, at the price of a fresh instance whenever they alternate.
+	 */
+	static Object Intern(Napi::Env env, const rs2_stream_profile* p) {
+		rs2_stream stream = RS2_STREAM_ANY;
+		rs2_format format = RS2_FORMAT_ANY;
+		int32_t index	  = 0;
+		int32_t unique_id = 0;
+		int32_t fps		  = 0;
+		rs2_error* error  = nullptr;
+		rs2_get_stream_profile_data(p, &stream, &format, &index, &unique_id, &fps, &error);
+		if (error) {
+			rs2_free_error(error);
+			return Object();
 		}
-		else if (
-		  GetNativeResult<
-			bool>(rs2_stream_profile_is, &unwrapped->error_, p, RS2_EXTENSION_MOTION_PROFILE, &unwrapped->error_)) {
-			unwrapped->is_motion_ = true;
+
+		auto registry = AddonData::Shared<Registry>(env);
+		auto entry	  = registry->profiles.find(unique_id);
+		if (entry != registry->profiles.end()) {
+			auto existing = entry->second.owner;
+			// Ids restart with every playback, so the profile must match as well.
+			if (
+			  existing->profile_ && existing->stream_ == stream && existing->format_ == format
+			  && existing->index_ == index && existing->fps_ == fps) {
+				auto instance = entry->second.ref.Value();
+				if (!instance.IsEmpty()) return instance;
+			}
+			existing->registry_ = nullptr;
+			registry->profiles.erase(entry);
 		}
 
-		return scope.Escape(napi_value(instance)).ToObject();
+		auto clone = rs2_clone_stream_profile(p, stream, index, format, &error);
+		if (!clone) {
+			if (error) rs2_free_error(error);
+			return Object();
+		}
+
+		auto instance  = NewInstance(env, clone, true);
+		auto unwrapped = ObjectWrap<RSStreamProfile>::Unwrap(instance);
+		// Clones may get an id of their own, the instance keeps the one the frames carry.
+		unwrapped->unique_id_		  = unique_id;
+		unwrapped->registry_		  = registry;
+		registry->profiles[unique_id] = InternedProfile{ Napi::Weak(instance), unwrapped };
+
+		return instance;
 	}
 
 	RSStreamProfile(const CallbackInfo& info)
@@ -94,7 +134,10 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 	  , height_(0)
 	  , is_default_(false)
 	  , own_profile_(false)
-	  , is_motion_(false) {
+	  , is_motion_(false)
+	  , details_loaded_(false)
+	  , has_intrinsics_(false)
+	  , has_motion_intrinsics_(false) {
 	}
 
 	~RSStreamProfile() {
@@ -104,7 +147,15 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
   private:
   	friend class RSSensor;
 
-	static FunctionReference constructor;
+	struct InternedProfile {
+		ObjectReference ref;
+		RSStreamProfile* owner;
+	};
+
+	// The interned profiles of one env, held by each of them so they can leave it even during teardown.
+	struct Registry {
+		std::unordered_map<int32_t, InternedProfile> profiles;
+	};
 
 	rs2_error* error_;
 	rs2_stream_profile* profile_;
@@ -119,16 +170,52 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 	bool is_default_;
 	bool own_profile_;
 	bool is_motion_;
+	bool details_loaded_;
+	// Set while this instance is the one interned for its unique id.
+	std::shared_ptr<Registry> registry_;
+	bool has_intrinsics_;
+	rs2_intrinsics intrinsics_;
+	bool has_motion_intrinsics_;
+	rs2_motion_device_intrinsic motion_intrinsics_;
+	std::unordered_map<int32_t, rs2_extrinsics> extrinsics_;
+
+	// The fields not needed to identify a stream, read at most once.
+	void LoadDetails() {
+		if (this->details_loaded_ || !this->profile_) return;
+
+		auto profile		  = this->profile_;
+		this->details_loaded_ = true;
+		this->is_default_
+		  = GetNativeResult<bool>(rs2_is_stream_profile_default, &this->error_, profile, &this->error_);
+		if (GetNativeResult<
+			  bool>(rs2_stream_profile_is, &this->error_, profile, RS2_EXTENSION_VIDEO_PROFILE, &this->error_)) {
+			this->is_video_ = true;
+			CallNativeFunc(
+			  rs2_get_video_stream_resolution, &this->error_, profile, &this->width_, &this->height_, &this->error_);
+		}
+		else if (GetNativeResult<
+				   bool>(rs2_stream_profile_is, &this->error_, profile, RS2_EXTENSION_MOTION_PROFILE, &this->error_)) {
+			this->is_motion_ = true;
+		}
+	}
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
+		if (registry_) {
+			auto entry = registry_->profiles.find(unique_id_);
+			if (entry != registry_->profiles.end() && entry->second.owner == this) registry_->profiles.erase(entry);
+			registry_ = nullptr;
+		}
 		error_ = nullptr;
 		if (profile_ && own_profile_) rs2_delete_stream_profile(profile_);
 		profile_ = nullptr;
+		has_intrinsics_		   = false;
+		has_motion_intrinsics_ = false;
+		extrinsics_.clear();
 	}
 
+	// Interned profiles are shared by every frame of their stream and only go away with their last reference.
 	Napi::Value Destroy(const CallbackInfo& info) {
-		this->DestroyMe();
+		if (!this->registry_) this->DestroyMe();
 		return info.This();
 	}
 
@@ -144,33 +231,47 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 		auto to = ObjectWrap<RSStreamProfile>::Unwrap(info[0].ToObject());
 		if (!to) return info.Env().Undefined();
 
-		rs2_extrinsics res;
-		CallNativeFunc(rs2_get_extrinsics, &this->error_, this->profile_, to->profile_, &res, &this->error_);
-		if (this->error_) return info.Env().Undefined();
+		auto cached = this->extrinsics_.find(to->unique_id_);
+		if (cached == this->extrinsics_.end()) {
+			rs2_extrinsics res;
+			CallNativeFunc(rs2_get_extrinsics, &this->error_, this->profile_, to->profile_, &res, &this->error_);
+			if (this->error_) return info.Env().Undefined();
+
+			cached = this->extrinsics_.emplace(to->unique_id_, res).first;
+		}
 
-		RSExtrinsics rsres(info.Env(), res);
+		RSExtrinsics rsres(info.Env(), cached->second);
 		return rsres.GetObject();
 	}
 
 	Napi::Value GetMotionIntrinsics(const CallbackInfo& info) {
-		rs2_motion_device_intrinsic output;
-		CallNativeFunc(rs2_get_motion_intrinsics, &this->error_, this->profile_, &output, &this->error_);
-		if (this->error_) return info.Env().Undefined();
+		if (!this->has_motion_intrinsics_) {
+			CallNativeFunc(
+			  rs2_get_motion_intrinsics, &this->error_, this->profile_, &this->motion_intrinsics_, &this->error_);
+			if (this->error_) return info.Env().Undefined();
+
+			this->has_motion_intrinsics_ = true;
+		}
 
-		RSMotionIntrinsics intrinsics(info.Env(), &output);
+		RSMotionIntrinsics intrinsics(info.Env(), &this->motion_intrinsics_);
 		return intrinsics.GetObject();
 	}
 
 	Napi::Value GetVideoStreamIntrinsics(const CallbackInfo& info) {
-		rs2_intrinsics intr;
-		CallNativeFunc(rs2_get_video_stream_intrinsics, &this->error_, this->profile_, &intr, &this->error_);
-		if (this->error_) return info.Env().Undefined();
+		if (!this->has_intrinsics_) {
+			CallNativeFunc(
+			  rs2_get_video_stream_intrinsics, &this->error_, this->profile_, &this->intrinsics_, &this->error_);
+			if (this->error_) return info.Env().Undefined();
+
+			this->has_intrinsics_ = true;
+		}
 
-		RSIntrinsics res(info.Env(), intr);
+		RSIntrinsics res(info.Env(), this->intrinsics_);
 		return res.GetObject();
 	}
 
 	Napi::Value Height(const CallbackInfo& info) {
+		this->LoadDetails();
 		return Number::New(info.Env(), this->height_);
 	}
 
@@ -179,14 +280,17 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 	}
 
 	Napi::Value IsDefault(const CallbackInfo& info) {
+		this->LoadDetails();
 		return Boolean::New(info.Env(), this->is_default_);
 	}
 
 	Napi::Value IsMotionProfile(const CallbackInfo& info) {
+		this->LoadDetails();
 		return Boolean::New(info.Env(), this->is_motion_);
 	}
 
 	Napi::Value IsVideoProfile(const CallbackInfo& info) {
+		this->LoadDetails();
 		return Boolean::New(info.Env(), this->is_video_);
 	}
 
@@ -199,10 +303,10 @@ class RSStreamProfile : public ObjectWrap<RSStreamProfile> {
 	}
 
 	Napi::Value Width(const CallbackInfo& info) {
+		this->LoadDetails();
 		return Number::New(info.Env(), this->width_);
 	}
 };
 
-Napi::FunctionReference RSStreamProfile::constructor;
 
 #endif
@@ -6,10 +6,12 @@
 
 class StreamProfileExtractor {
   public:
-	explicit StreamProfileExtractor(const rs2_stream_profile* profile) {
+	explicit StreamProfileExtractor(const rs2_stream_profile* profile)
+	  : error_(nullptr) {
 		rs2_get_stream_profile_data(profile, &stream_, &format_, &index_, &unique_id_, &fps_, &error_);
 	}
 	~StreamProfileExtractor() {
+		if (error_) rs2_free_error(error_);
 	}
 	rs2_stream stream_;
 	rs2_format format_;
@@ -20,8 +20,7 @@ class RSSyncer : public ObjectWrap<RSSyncer> {
 			InstanceMethod("pollForFrames", &RSSyncer::PollForFrames),
 			InstanceMethod("waitForFrames", &RSSyncer::WaitForFrames),
 		  });
-		constructor = Napi::Persistent(func);
-		constructor.SuppressDestruct();
+		AddonData::SetConstructor<RSSyncer>(env, func);
 		exports.Set("RSSyncer", func);
 
 		return exports;
@@ -29,7 +28,7 @@ class RSSyncer : public ObjectWrap<RSSyncer> {
 
 	static Object NewInstance(Napi::Env env) {
 		EscapableHandleScope scope(env);
-		Object instance = constructor.New({});
+		Object instance = AddonData::Constructor<RSSyncer>(env).New({});
 
 		return scope.Escape(napi_value(instance)).ToObject();
 	}
@@ -51,15 +50,12 @@ class RSSyncer : public ObjectWrap<RSSyncer> {
 	}
 
   private:
-  	static FunctionReference constructor;
-
 	rs2_processing_block* syncer_;
 	rs2_frame_queue* frame_queue_;
 	rs2_error* error_;
 	friend class RSSensor;
 
 	void DestroyMe() {
-		if (error_) rs2_free_error(error_);
 		error_ = nullptr;
 		if (syncer_) rs2_delete_processing_block(syncer_);
 		syncer_ = nullptr;
@@ -101,6 +97,4 @@ class RSSyncer : public ObjectWrap<RSSyncer> {
 	}
 };
 
-Napi::FunctionReference RSSyncer::constructor;
-
 #endif
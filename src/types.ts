@@ -10,18 +10,31 @@ import {
 
 export interface RealSenseAddon {
   cleanup(): void;
+  depthToMeters(depth: Uint16Array, out: Float32Array, scale: number): number;
+  readonly frameMetadataCount: number;
+  getError(): RSNativeError | undefined;
   getTime(): number;
   registerErrorCallback: ErrorCallbackRegistration;
+  setErrorMode(mode: RSErrorMode): void;
   RSAlign: new () => RSAlign;
   RSColorizer: new () => RSColorizer;
   RSConfig: new () => RSConfig;
   RSContext: new () => RSContext;
   RSDevice: new () => RSDevice;
   RSDeviceList: new () => RSDeviceList;
+  RSFilter: new (type: RSFilterType) => RSFilter;
   RSFrame: new () => RSFrame;
+  RSFrameBus: RSFrameBusConstructor;
+  RSFrameBusSubscriber: new () => RSFrameBusSubscriber;
+  RSFrameQueue: new () => RSFrameQueue;
   RSFrameSet: new () => RSFrameSet;
+  RSFramePublisher: RSFramePublisherConstructor;
+  RSImuBatcher: new () => RSImuBatcher;
   RSPipeline: new () => RSPipeline;
   RSPipelineProfile: new () => RSPipelineProfile;
+  RSPointCloud: new () => RSPointCloud;
+  RSPoseHistory: new (capacity?: number) => RSPoseHistory;
+  RSProcessingGraph: new () => RSProcessingGraph;
   RSSensor: new () => RSSensor;
   RSStreamProfile: new () => RSStreamProfile;
   RSSyncer: new () => RSSyncer;
@@ -30,6 +43,18 @@ export interface RealSenseAddon {
 type DevicesChangedCallback = (removed: RSDeviceList, added: RSDeviceList) => void;
 type ErrorCallbackRegistration = <T extends object>(recv: T, fn: keyof T) => void;
 
+/**
+ * How native failures reach JS: the registered error callback, a thrown Error carrying the same
+ * recoverable and nativeFunction fields, or only getError() until the next native call.
+ */
+export type RSErrorMode = 'callback' | 'throw' | 'record';
+
+export interface RSNativeError {
+  recoverable: boolean;
+  description: string;
+  nativeFunction: string;
+}
+
 export interface XYZ {
   x: number;
   y: number;
@@ -50,7 +75,9 @@ export interface RSAlign {
 }
 
 export interface RSColorizer {
+  applyOptions(ids: Int32Array, values: Float32Array): Int32Array | undefined;
   destroy(): this;
+  getAllOptions(): RSOptionSnapshot;
 }
 
 export interface RSConfig {
@@ -103,20 +130,50 @@ export interface RSExtrinsics {
   translation: [number, number, number];
 }
 
+export type RSFilterType =
+  | 'decimation'
+  | 'depth-to-disparity'
+  | 'disparity-to-depth'
+  | 'hole-filling'
+  | 'spatial'
+  | 'temporal';
+
+export interface RSFilter {
+  applyOptions(ids: Int32Array, values: Float32Array): Int32Array | undefined;
+  destroy(): this;
+  getAllOptions(): RSOptionSnapshot;
+  getOption(option: RSOption): number;
+  getOptionDescription(option: RSOption): string;
+  getOptionRange(option: RSOption): RSOptionRange;
+  getOptionValueDescription(option: RSOption, value: number): string;
+  isOptionReadonly(option: RSOption): boolean;
+  /** Throws while processAsync() or processBatch() calls are still pending */
+  process(input: RSFrame, output: RSFrame): boolean;
+  processAsync(input: RSFrame): Promise<RSFrame | RSFrameSet | undefined>;
+  processBatch(inputs: RSFrame[]): Promise<Array<RSFrame | RSFrameSet | undefined>>;
+  setOption(option: RSOption, value: number): void;
+  supportsOption(option: RSOption): boolean;
+}
+
 export interface RSFrame {
+  /** Bitmask of RSFrameTypeFlag, read once when the frame is wrapped */
+  readonly type: number;
   canGetPoints(): boolean;
   destroy(): this;
   exportToPly(filename: string, frame: RSFrame): this;
+  getAllMetadata(values: BigInt64Array | Float64Array, presentMask: Uint32Array): number;
   getBaseLine(): number;
   getBitsPerPixel(): number;
   getData(): Uint8Array;
   getDistance(x: number, y: number): number;
+  getDistanceGrid(stepX: number, stepY: number, out: Float32Array): number;
+  getDistances(coords: Int32Array, out: Float32Array): number;
   getFrameMetadata(metadata: RSFrameMetadata, data: Uint8Array): boolean;
   getFrameNumber(): number;
   getHeight(): number;
   getMotionData(xyz: XYZ): this;
   getPointsCount(): number;
-  getPoseData(data: RSPose): boolean;
+  getPoseData(data: RSPose | Float32Array): boolean;
   getStreamProfile(): RSStreamProfile;
   getStrideInBytes(): number;
   getTexCoordBufferLen(): number;
@@ -133,8 +190,18 @@ export interface RSFrame {
   isValid(): boolean;
   isVideoFrame(): boolean;
   keep(): this;
+  readHeader(out: Float64Array): boolean;
   supportsFrameMetadata(metadata: RSFrameMetadata): boolean;
   writeData(data: ArrayBuffer): this;
+  writeDepthMeters(
+    out: Float32Array,
+    scale?: number,
+    x?: number,
+    y?: number,
+    width?: number,
+    height?: number,
+    outStride?: number
+  ): boolean;
   writeTextureCoordinates(coords: ArrayBuffer): boolean;
   writeVertices(vertices: ArrayBuffer): boolean;
 }
@@ -142,12 +209,48 @@ export interface RSFrame {
 export interface RSFrameSet {
   destroy(): this;
   getFrame(stream: RSStreamType, streamIndex: number): RSFrame;
+  getFrames(): RSFrameSetEntry[];
   getSize(): number;
   indexToStream(index: number): RSStreamType;
   indexToStreamIndex(index: number): number;
   replaceFrame(stream: RSStreamType, streamIndex: number, frame: RSFrame): boolean;
 }
 
+export type RSFrameType = 'pose' | 'motion' | 'disparity' | 'depth' | 'video' | 'points' | 'frame';
+
+export interface RSFrameSetEntry {
+  frame: RSFrame;
+  stream: RSStreamType;
+  streamIndex: number;
+  type: RSFrameType;
+}
+
+export interface RSFrameQueue {
+  create(capacity?: number, keepFrames?: boolean): this;
+  destroy(): this;
+  enqueueFrame(frame: RSFrame): boolean;
+  getStats(): RSFrameQueueStats | undefined;
+  poll(): RSFrame | RSFrameSet | undefined;
+  waitForFrame(timeout?: number): RSFrame | RSFrameSet | undefined;
+  waitForFrameAsync(timeout?: number): Promise<RSFrame | RSFrameSet | undefined>;
+}
+
+export type RSFrameQueuePolicy = 'latest-only' | 'drop-oldest' | 'block';
+
+export interface RSFrameQueueOptions {
+  capacity?: number;
+  policy?: RSFrameQueuePolicy;
+}
+
+export interface RSFrameQueueStats {
+  capacity: number;
+  delivered: number;
+  depth: number;
+  dropped: number;
+  enqueued: number;
+  highWater: number;
+}
+
 export interface RSIntrinsics {
   coeffs: [number, number, number, number, number];
   fx: number;
@@ -180,14 +283,80 @@ export interface RSOptionRange {
   step: number;
 }
 
+/**
+ * Called with a reused Float64Array holding `count` (timestamp, x, y, z, stream) tuples;
+ * the batch must be consumed before returning.
+ */
+export interface RSFrameBusConstructor {
+  new (): RSFrameBus;
+  /**
+   * Removes a shared memory object left behind by a process that died without destroy(), so create()
+   * can use the name again. Returns false when there was none.
+   */
+  unlink(name: string): boolean;
+}
+
+export interface RSFrameBus {
+  /** Fails with EEXIST when a shared memory object of that name exists already, see RSFrameBusConstructor.unlink */
+  create(name: string, slotCount: number, slotBytes: number, streams?: RSStreamType[]): this;
+  /** Unlinks the shared memory, subscribers that have it mapped keep reading */
+  destroy(): this;
+}
+
+export interface RSFrameBusSubscriber {
+  destroy(): this;
+  /** The whole ring, mapped without copying, to read with FrameRingReader */
+  getBuffer(): ArrayBuffer | undefined;
+  open(name: string): this;
+  /** Blocks until the published count differs from the one given, or the timeout, and returns it */
+  waitForFrame(published: number, timeoutMs?: number): number | undefined;
+  waitForFrameAsync(published: number, timeoutMs?: number): Promise<number>;
+}
+
+export interface RSFramePublisherConstructor {
+  new (): RSFramePublisher;
+  /** Bytes needed by a ring of slotCount slots holding frames of up to slotBytes bytes */
+  byteLength(slotCount: number, slotBytes: number): number;
+}
+
+export interface RSFramePublisher {
+  /** ring must view a SharedArrayBuffer, any other buffer throws a TypeError */
+  create(ring: Int32Array | Uint8Array, slotCount: number, slotBytes: number, streams?: RSStreamType[]): this;
+  destroy(): this;
+}
+
+export type RSImuBatchCallback = (batch: Float64Array, count: number) => void;
+
+export interface RSImuBatcher {
+  create(callback: RSImuBatchCallback, batchSize?: number, maxLatencyMs?: number): this;
+  destroy(): this;
+  flush(): this;
+  getDropped(): number;
+}
+
+/** Supported options and their current values, in matching order */
+export interface RSOptionSnapshot {
+  ids: Int32Array;
+  values: Float32Array;
+}
+
 export interface RSPipeline {
   create(context?: RSContext): this;
   destroy(): this;
   getActiveProfile(): RSPipelineProfile;
+  getFrameQueueStats(): RSFrameQueueStats | undefined;
   pollForFrames(frameset: RSFrameSet): boolean;
   start(config?: RSConfig): RSPipelineProfile;
+  startWithCallback(
+    callback: (frameset: RSFrameSet) => void,
+    config?: RSConfig,
+    options?: RSFrameQueueOptions
+  ): RSPipelineProfile | undefined;
+  startWithFrameBus(bus: RSFrameBus, config?: RSConfig): RSPipelineProfile | undefined;
+  startWithFramePublisher(publisher: RSFramePublisher, config?: RSConfig): RSPipelineProfile | undefined;
   stop(): this;
   waitForFrames(frameset: RSFrameSet, timeout?: number): boolean;
+  waitForFramesAsync(timeout?: number): Promise<RSFrameSet | undefined>;
 }
 
 export interface RSPipelineProfile {
@@ -196,6 +365,22 @@ export interface RSPipelineProfile {
   getStreams(): RSStreamProfile[];
 }
 
+export interface RSPointCloud {
+  applyOptions(ids: Int32Array, values: Float32Array): Int32Array | undefined;
+  calculate(depth: RSFrame): RSFrame | undefined;
+  calculate(depth: RSFrame, vertices: Float32Array, textureCoordinates?: Float32Array): number | undefined;
+  destroy(): this;
+  getAllOptions(): RSOptionSnapshot;
+  getOption(option: RSOption): number;
+  getOptionDescription(option: RSOption): string;
+  getOptionRange(option: RSOption): RSOptionRange;
+  getOptionValueDescription(option: RSOption, value: number): string;
+  isOptionReadonly(option: RSOption): boolean;
+  mapTo(texture: RSFrame): this;
+  setOption(option: RSOption, value: number): void;
+  supportsOption(option: RSOption): boolean;
+}
+
 export interface RSPose {
   acceleration: XYZ;
   angularAcceleration: XYZ;
@@ -207,6 +392,54 @@ export interface RSPose {
   velocity: XYZ;
 }
 
+export type RSProcessingStageType =
+  | 'align'
+  | 'colorizer'
+  | 'decimation'
+  | 'depth-to-disparity'
+  | 'disparity-to-depth'
+  | 'hole-filling'
+  | 'pointcloud'
+  | 'spatial'
+  | 'temporal';
+
+export type RSProcessingStage = RSProcessingStageType | {
+  options?: Partial<Record<RSOption, number>>;
+  stream?: RSStreamType;
+  type: RSProcessingStageType;
+};
+
+export interface RSProcessingGraph {
+  create(stages: RSProcessingStage[]): this | undefined;
+  destroy(): this;
+  getStats(): RSProcessingGraphStats;
+  start(
+    pipeline: RSPipeline,
+    callback: (frames: RSFrameSet | RSFrame) => void,
+    config?: RSConfig
+  ): RSPipelineProfile | undefined;
+  stop(): this;
+}
+
+export interface RSProcessingGraphStats {
+  errors: number;
+  input: RSFrameQueueStats;
+  lastError?: string;
+  lastProcessingMs: number;
+  output: RSFrameQueueStats;
+  processed: number;
+}
+
+export interface RSPoseHistory {
+  clear(): this;
+  destroy(): this;
+  getRange(): [number, number];
+  getSize(): number;
+  poseAt(timestamp: number, out: Float32Array): boolean;
+  push(frame: RSFrame | RSFrameSet): this;
+  pushPose(timestamp: number, pose: Float32Array): boolean;
+}
+
 export interface RSRegionOfInterest {
   maxX: number;
   maxY: number;
@@ -217,8 +450,11 @@ export interface RSRegionOfInterest {
 export interface RSSensor {
   readonly isDepthSensor: boolean;
   readonly isROISensor: boolean;
+  applyOptions(ids: Int32Array, values: Float32Array): Int32Array | undefined;
   close(): this;
   destroy(): this;
+  findProfile(query: RSStreamProfileQuery): RSStreamProfile | undefined;
+  getAllOptions(): RSOptionSnapshot;
   getCameraInfo(index: number): string;
   getDepthScale(): number;
   getOption(option: RSOption): number;
@@ -226,6 +462,8 @@ export interface RSSensor {
   getOptionRange(option: RSOption): RSOptionRange;
   getOptionValueDescription(option: RSOption, value: number): string;
   getRegionOfInterest(): RSRegionOfInterest;
+  getStreamProfileAt(row: number): RSStreamProfile | undefined;
+  getStreamProfileTable(): RSStreamProfileTable | undefined;
   getStreamProfiles(): RSStreamProfile;
   isOptionReadonly(option: RSOption): boolean;
   onNotification(callback: (notification: RSNotification) => void): this;
@@ -233,15 +471,39 @@ export interface RSSensor {
   openStream(stream: RSStreamProfile): this;
   setOption(option: RSOption, value: number): this;
   setRegionOfInterest(minx: number, miny: number, maxx: number, maxy: number): this;
-  // startWithCallback
+  startWithCallback(
+    callback: (frame: RSFrame) => void,
+    frame: RSFrame,
+    depthFrame: RSFrame,
+    videoFrame: RSFrame,
+    disparityFrame: RSFrame,
+    motionFrame: RSFrame,
+    poseFrame: RSFrame
+  ): this;
+  startWithFrameBus(bus: RSFrameBus): this;
+  startWithFramePublisher(publisher: RSFramePublisher): this;
+  startWithFrameQueue(queue: RSFrameQueue): this;
+  startWithImuBatcher(batcher: RSImuBatcher): this;
+  startWithPoseHistory(history: RSPoseHistory): this;
   startWithSyncer(syncer: RSSyncer): this;
   stop(): void;
   supportsCameraInfo(camera: number): boolean;
   supportsOption(option: RSOption): boolean;
+  unwatchOptions(): this;
+  /** intervalMs must be at least 10, undefined polls every 100 ms */
+  watchOptions(
+    options: Int32Array | RSOption[],
+    intervalMs: number | undefined,
+    callback: RSOptionChangeCallback
+  ): this;
 }
 
+/** Called with the options whose value changed since the previous call, in matching order */
+export type RSOptionChangeCallback = (ids: Int32Array, values: Float32Array) => void;
+
 
 export interface RSStreamProfile {
+  /** Does nothing for the profiles of frames, which are shared by every frame of their stream */
   destroy(): this;
   format: RSFormat;
   fps: number;
@@ -258,6 +520,28 @@ export interface RSStreamProfile {
   width: number;
 }
 
+/** Fields a profile must have; missing or zero fields match anything */
+export interface RSStreamProfileQuery {
+  format?: RSFormat;
+  fps?: number;
+  height?: number;
+  index?: number;
+  stream?: RSStreamType;
+  width?: number;
+}
+
+/** One row per profile, in the order of getStreamProfiles(); width and height are 0 for non-video profiles */
+export interface RSStreamProfileTable {
+  count: number;
+  format: Int32Array;
+  fps: Int32Array;
+  height: Int32Array;
+  index: Int32Array;
+  stream: Int32Array;
+  uniqueId: Int32Array;
+  width: Int32Array;
+}
+
 export interface RSSyncer {
   destroy(): this;
   pollForFrames(frameset: RSFrameSet): boolean;
@@ -3,14 +3,21 @@
 
 #include "error_util.cc"
 #include <librealsense2/hpp/rs_types.hpp>
+#include <napi.h>
+#include <string>
 
+/**
+ * Wrap a librealsense call, from any thread. On failure `*error` is left set, as a flag only: the error
+ * itself belongs to ErrorUtil, so callers must not free it. Off the JS thread `error` must point to a
+ * variable of the calling thread, not to a slot of a JS object.
+ */
 template<typename R, typename F, typename... arguments>
 R GetNativeResult(F func, rs2_error** error, arguments... params) {
 	// reset the error pointer for each call.
 	*error = nullptr;
 	ErrorUtil::ResetError();
 	R val = func(params...);
-	ErrorUtil::AnalyzeError(*error);
+	if (*error) ErrorUtil::AnalyzeError(*error);
 	return val;
 }
 
@@ -20,7 +27,19 @@ void CallNativeFunc(F func, rs2_error** error, arguments... params) {
 	*error = nullptr;
 	ErrorUtil::ResetError();
 	func(params...);
-	ErrorUtil::AnalyzeError(*error);
+	if (*error) ErrorUtil::AnalyzeError(*error);
+}
+
+/**
+ * As<Float32Array>() and the like do not check the element type, so output and input arrays that are
+ * accessed through Data() must be checked first. Throws a TypeError naming the argument when value is
+ * not a typed array of the given type.
+ */
+inline bool ExpectTypedArray(const Napi::Value& value, napi_typedarray_type type, const char* expected) {
+	if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == type) return true;
+
+	Napi::TypeError::New(value.Env(), std::string("Expected a ") + expected).ThrowAsJavaScriptException();
+	return false;
 }
 
 #endif